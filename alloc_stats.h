@@ -0,0 +1,365 @@
+//
+// Allocation accounting.
+//
+// alloc_stats_install() routes SDL_malloc & co. through counting wrappers (SDL_SetMemoryFunctions), and
+// alloc_stats_malloc/realloc/free do the same for code that uses the C library directly (the curl buffers).
+// Every live block is remembered with its size and the subsystem tag that was active when it was allocated, so
+// alloc_stats_report() can print per-subsystem totals and everything that is still allocated (leaks).
+//
+// Per frame: wrap the UI loop body in alloc_stats_frame_begin()/alloc_stats_frame_end(). Once the app has warmed up
+// a frame is expected not to allocate at all; if it does, the offending tag is logged and SDL_assert fires.
+// Work that legitimately allocates (loading a directory listing) goes between ALLOC_ALLOW_BEGIN/END.
+//
+// Tags and allowed sections belong to the thread that set them, and only allocations made by the thread that called
+// alloc_stats_frame_begin() count against its frame: render, raster and other worker threads are tallied per tag
+// but never trip the frame check.
+//
+// Build with ENABLE_ALLOC_STATS (cmake -DENABLE_ALLOC_STATS=ON); otherwise this is all no-ops and plain libc calls.
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+
+#ifdef ENABLE_ALLOC_STATS
+
+#define ALLOC_STATS_TABLE_SIZE 8192 // live blocks that can be tracked, power of two
+#define ALLOC_STATS_MAX_TAGS   16
+#define ALLOC_STATS_WARMUP     120 // frames before the allocation-free rule is enforced
+
+typedef struct {
+    void *ptr;
+    size_t size;
+    Uint8 tag;
+} alloc_block_t;
+
+// Per thread, in SDL TLS; allocated with the C library so creating it is never counted
+typedef struct {
+    char const *tag_stack[8];
+    int tag_depth;
+    int allow_depth;
+} alloc_thread_t;
+
+typedef struct {
+    char const *name;
+    Uint64 allocs;
+    Uint64 frees;
+    Uint64 bytes;
+    Uint64 live_bytes;
+    Uint64 live_blocks;
+} alloc_tag_stats_t;
+
+static struct {
+    SDL_SpinLock lock;
+    SDL_malloc_func real_malloc;
+    SDL_calloc_func real_calloc;
+    SDL_realloc_func real_realloc;
+    SDL_free_func real_free;
+    alloc_block_t blocks[ALLOC_STATS_TABLE_SIZE];
+    alloc_tag_stats_t tags[ALLOC_STATS_MAX_TAGS];
+    int num_tags;
+    SDL_TLSID thread;
+    Uint64 untracked; // blocks that didn't fit in the table
+    SDL_ThreadID frame_thread;
+    Uint64 frame;
+    Uint64 frame_allocs;
+    Uint64 frame_bytes;
+    char const *frame_first_tag;
+} alloc_stats_;
+
+static void SDLCALL alloc_stats_thread_free_(void *thread) {
+    free(thread);
+}
+
+// The calling thread's state; NULL if it never tagged or allowed anything (and `create` is false or out of memory)
+static inline alloc_thread_t *alloc_stats_thread_(bool create) {
+    alloc_thread_t *thread = (alloc_thread_t *) SDL_GetTLS(&alloc_stats_.thread);
+    if (!thread && create) {
+        thread = (alloc_thread_t *) calloc(1, sizeof(alloc_thread_t));
+        if (thread && !SDL_SetTLS(&alloc_stats_.thread, thread, alloc_stats_thread_free_)) {
+            free(thread);
+            thread = NULL;
+        }
+    }
+    return thread;
+}
+
+static inline Uint8 alloc_stats_tag_index_(alloc_thread_t const *thread) {
+    const int depth = thread ? SDL_min(thread->tag_depth, (int) SDL_arraysize(thread->tag_stack)) : 0;
+    char const *name = depth > 0 ? thread->tag_stack[depth - 1] : "untagged";
+    for (int i = 0; i < alloc_stats_.num_tags; i++) {
+        if (alloc_stats_.tags[i].name == name) {
+            return (Uint8) i;
+        }
+    }
+    if (alloc_stats_.num_tags == ALLOC_STATS_MAX_TAGS) {
+        return ALLOC_STATS_MAX_TAGS - 1;
+    }
+    alloc_stats_.tags[alloc_stats_.num_tags].name = name;
+    return (Uint8) alloc_stats_.num_tags++;
+}
+
+static inline size_t alloc_stats_slot_(void const *ptr) {
+    return (((uintptr_t) ptr >> 3) * 0x9E3779B1u) & (ALLOC_STATS_TABLE_SIZE - 1);
+}
+
+// Called with the lock held.
+static inline void alloc_stats_note_(void *ptr, size_t size) {
+    alloc_thread_t const *thread = alloc_stats_thread_(false);
+    const Uint8 tag = alloc_stats_tag_index_(thread);
+    alloc_tag_stats_t *t = &alloc_stats_.tags[tag];
+    t->allocs++;
+    t->bytes += size;
+    if ((!thread || thread->allow_depth == 0) && alloc_stats_.frame_thread == SDL_GetCurrentThreadID()) {
+        if (alloc_stats_.frame_allocs++ == 0) {
+            alloc_stats_.frame_first_tag = t->name;
+        }
+        alloc_stats_.frame_bytes += size;
+    }
+
+    size_t slot = alloc_stats_slot_(ptr);
+    for (size_t probe = 0; probe < ALLOC_STATS_TABLE_SIZE; probe++) {
+        alloc_block_t *b = &alloc_stats_.blocks[slot];
+        if (!b->ptr) {
+            b->ptr = ptr;
+            b->size = size;
+            b->tag = tag;
+            t->live_bytes += size;
+            t->live_blocks++;
+            return;
+        }
+        slot = (slot + 1) & (ALLOC_STATS_TABLE_SIZE - 1);
+    }
+    alloc_stats_.untracked++;
+}
+
+// Called with the lock held. Blocks from before alloc_stats_install() simply aren't found.
+static inline void alloc_stats_forget_(void *ptr) {
+    size_t slot = alloc_stats_slot_(ptr);
+    for (size_t probe = 0; probe < ALLOC_STATS_TABLE_SIZE; probe++) {
+        alloc_block_t *b = &alloc_stats_.blocks[slot];
+        if (!b->ptr) {
+            return;
+        }
+        if (b->ptr == ptr) {
+            alloc_tag_stats_t *t = &alloc_stats_.tags[b->tag];
+            t->frees++;
+            t->live_bytes -= b->size;
+            t->live_blocks--;
+            b->ptr = NULL;
+            // Backward-shift deletion keeps the linear probe chains intact without tombstones
+            size_t hole = slot;
+            size_t next = (slot + 1) & (ALLOC_STATS_TABLE_SIZE - 1);
+            while (alloc_stats_.blocks[next].ptr) {
+                const size_t home = alloc_stats_slot_(alloc_stats_.blocks[next].ptr);
+                if (((next - home) & (ALLOC_STATS_TABLE_SIZE - 1)) >= ((next - hole) & (ALLOC_STATS_TABLE_SIZE - 1))) {
+                    alloc_stats_.blocks[hole] = alloc_stats_.blocks[next];
+                    alloc_stats_.blocks[next].ptr = NULL;
+                    hole = next;
+                }
+                next = (next + 1) & (ALLOC_STATS_TABLE_SIZE - 1);
+            }
+            return;
+        }
+        slot = (slot + 1) & (ALLOC_STATS_TABLE_SIZE - 1);
+    }
+}
+
+static void *SDLCALL alloc_stats_sdl_malloc_(size_t size) {
+    void *ptr = alloc_stats_.real_malloc(size);
+    if (ptr) {
+        SDL_LockSpinlock(&alloc_stats_.lock);
+        alloc_stats_note_(ptr, size);
+        SDL_UnlockSpinlock(&alloc_stats_.lock);
+    }
+    return ptr;
+}
+
+static void *SDLCALL alloc_stats_sdl_calloc_(size_t nmemb, size_t size) {
+    void *ptr = alloc_stats_.real_calloc(nmemb, size);
+    if (ptr) {
+        SDL_LockSpinlock(&alloc_stats_.lock);
+        alloc_stats_note_(ptr, nmemb * size);
+        SDL_UnlockSpinlock(&alloc_stats_.lock);
+    }
+    return ptr;
+}
+
+static void *SDLCALL alloc_stats_sdl_realloc_(void *mem, size_t size) {
+    void *ptr = alloc_stats_.real_realloc(mem, size);
+    if (ptr || size == 0) {
+        SDL_LockSpinlock(&alloc_stats_.lock);
+        if (mem) {
+            alloc_stats_forget_(mem);
+        }
+        if (ptr) {
+            alloc_stats_note_(ptr, size);
+        }
+        SDL_UnlockSpinlock(&alloc_stats_.lock);
+    }
+    return ptr;
+}
+
+static void SDLCALL alloc_stats_sdl_free_(void *mem) {
+    if (mem) {
+        SDL_LockSpinlock(&alloc_stats_.lock);
+        alloc_stats_forget_(mem);
+        SDL_UnlockSpinlock(&alloc_stats_.lock);
+    }
+    alloc_stats_.real_free(mem);
+}
+
+// Call before anything else touches SDL.
+static inline bool alloc_stats_install(void) {
+    SDL_GetMemoryFunctions(
+        &alloc_stats_.real_malloc,
+        &alloc_stats_.real_calloc,
+        &alloc_stats_.real_realloc,
+        &alloc_stats_.real_free
+    );
+    return SDL_SetMemoryFunctions(
+        alloc_stats_sdl_malloc_,
+        alloc_stats_sdl_calloc_,
+        alloc_stats_sdl_realloc_,
+        alloc_stats_sdl_free_
+    );
+}
+
+// Counting replacements for the C library allocator, for buffers that never go through SDL.
+static inline void *alloc_stats_malloc(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr) {
+        SDL_LockSpinlock(&alloc_stats_.lock);
+        alloc_stats_note_(ptr, size);
+        SDL_UnlockSpinlock(&alloc_stats_.lock);
+    }
+    return ptr;
+}
+
+static inline void *alloc_stats_realloc(void *mem, size_t size) {
+    void *ptr = realloc(mem, size);
+    if (ptr || size == 0) {
+        SDL_LockSpinlock(&alloc_stats_.lock);
+        if (mem) {
+            alloc_stats_forget_(mem);
+        }
+        if (ptr) {
+            alloc_stats_note_(ptr, size);
+        }
+        SDL_UnlockSpinlock(&alloc_stats_.lock);
+    }
+    return ptr;
+}
+
+static inline void alloc_stats_free(void *mem) {
+    if (mem) {
+        SDL_LockSpinlock(&alloc_stats_.lock);
+        alloc_stats_forget_(mem);
+        SDL_UnlockSpinlock(&alloc_stats_.lock);
+    }
+    free(mem);
+}
+
+// Tag and allow state is only ever touched by its own thread, so these need no lock
+static inline void alloc_stats_push_tag_(char const *tag) {
+    alloc_thread_t *thread = alloc_stats_thread_(true);
+    if (!thread) {
+        return;
+    }
+    if (thread->tag_depth < (int) SDL_arraysize(thread->tag_stack)) {
+        thread->tag_stack[thread->tag_depth] = tag;
+    }
+    thread->tag_depth++;
+}
+
+static inline void alloc_stats_pop_tag_(void) {
+    alloc_thread_t *thread = alloc_stats_thread_(false);
+    if (thread && thread->tag_depth > 0) {
+        thread->tag_depth--;
+    }
+}
+
+static inline void alloc_stats_allow_(int delta) {
+    alloc_thread_t *thread = alloc_stats_thread_(true);
+    if (thread) {
+        thread->allow_depth += delta;
+    }
+}
+
+static inline void alloc_stats_frame_begin(void) {
+    const SDL_ThreadID self = SDL_GetCurrentThreadID();
+    SDL_LockSpinlock(&alloc_stats_.lock);
+    alloc_stats_.frame_thread = self;
+    alloc_stats_.frame_allocs = 0;
+    alloc_stats_.frame_bytes = 0;
+    alloc_stats_.frame_first_tag = NULL;
+    SDL_UnlockSpinlock(&alloc_stats_.lock);
+}
+
+static inline void alloc_stats_frame_end(void) {
+    SDL_LockSpinlock(&alloc_stats_.lock);
+    const Uint64 frame = ++alloc_stats_.frame;
+    const Uint64 allocs = alloc_stats_.frame_allocs;
+    const Uint64 bytes = alloc_stats_.frame_bytes;
+    char const *tag = alloc_stats_.frame_first_tag;
+    SDL_UnlockSpinlock(&alloc_stats_.lock);
+
+    if (frame > ALLOC_STATS_WARMUP && allocs > 0) {
+        SDL_Log("alloc_stats: frame %" SDL_PRIu64 " allocated %" SDL_PRIu64 " blocks / %" SDL_PRIu64 " bytes (first in '%s')",
+                frame, allocs, bytes, tag);
+        SDL_assert(allocs == 0 && "allocation in the frame loop after warm-up");
+    }
+}
+
+static inline void alloc_stats_report(void) {
+    // Copy out first: logging may allocate, which would re-enter the hooks
+    alloc_tag_stats_t tags[ALLOC_STATS_MAX_TAGS];
+    alloc_block_t leaks[16];
+    int num_leaks = 0;
+    SDL_LockSpinlock(&alloc_stats_.lock);
+    const int num_tags = alloc_stats_.num_tags;
+    SDL_memcpy(tags, alloc_stats_.tags, sizeof(tags));
+    const Uint64 untracked = alloc_stats_.untracked;
+    for (int i = 0; i < ALLOC_STATS_TABLE_SIZE && num_leaks < (int) SDL_arraysize(leaks); i++) {
+        if (alloc_stats_.blocks[i].ptr) {
+            leaks[num_leaks++] = alloc_stats_.blocks[i];
+        }
+    }
+    SDL_UnlockSpinlock(&alloc_stats_.lock);
+
+    SDL_Log("alloc_stats: %-22s %10s %10s %12s %12s %8s", "tag", "allocs", "frees", "bytes", "live bytes", "live");
+    for (int i = 0; i < num_tags; i++) {
+        SDL_Log("alloc_stats: %-22s %10" SDL_PRIu64 " %10" SDL_PRIu64 " %12" SDL_PRIu64 " %12" SDL_PRIu64 " %8" SDL_PRIu64,
+                tags[i].name, tags[i].allocs, tags[i].frees, tags[i].bytes, tags[i].live_bytes, tags[i].live_blocks);
+    }
+    for (int i = 0; i < num_leaks; i++) {
+        SDL_Log("alloc_stats: still allocated %p, %u bytes from '%s'",
+                leaks[i].ptr, (unsigned) leaks[i].size, tags[leaks[i].tag].name);
+    }
+    if (untracked) {
+        SDL_Log("alloc_stats: %" SDL_PRIu64 " blocks were too many to track", untracked);
+    }
+}
+
+#define ALLOC_TAG_PUSH(tag)  alloc_stats_push_tag_(tag)
+#define ALLOC_TAG_POP()      alloc_stats_pop_tag_()
+#define ALLOC_ALLOW_BEGIN()  alloc_stats_allow_(1)
+#define ALLOC_ALLOW_END()    alloc_stats_allow_(-1)
+
+#else
+
+static inline bool alloc_stats_install(void) { return true; }
+static inline void *alloc_stats_malloc(size_t size) { return malloc(size); }
+static inline void *alloc_stats_realloc(void *mem, size_t size) { return realloc(mem, size); }
+static inline void alloc_stats_free(void *mem) { free(mem); }
+static inline void alloc_stats_frame_begin(void) {}
+static inline void alloc_stats_frame_end(void) {}
+static inline void alloc_stats_report(void) {}
+
+#define ALLOC_TAG_PUSH(tag)  ((void) 0)
+#define ALLOC_TAG_POP()      ((void) 0)
+#define ALLOC_ALLOW_BEGIN()  ((void) 0)
+#define ALLOC_ALLOW_END()    ((void) 0)
+
+#endif
@@ -0,0 +1,504 @@
+//
+// Display lists and a tile-binned, multithreaded rasterizer.
+//
+// Drawing code records commands (filled rects and font glyphs, colors already px_encode()d) into a dl_list_t;
+// dl_rasterize() then plays the list into the framebuffer. Big lists are binned into DL_TILE_SIZE square tiles and
+// the tiles are shared out over a small worker pool, with the calling thread pitching in. Each tile replays its
+// commands in recording order, clipped to the tile, so every pixel sees the same sequence of writes as it would
+// serially and the output is identical to single-threaded rendering.
+//
+//     dl_raster_init(&raster, pixels, 720, 720, -1);   // -1: one worker per extra core, 0: always serial
+//     dl_push_rect(&list, x, y, w, h, color);
+//     dl_push_char(&list, x, y, 'A', color);
+//     dl_rasterize(&raster, &list);                    // also empties the list
+//
+// Pixels are this build's px_t (pixfmt.h). Define DL_STRIDE to the target width to compile the row addressing
+// with a constant stride.
+//
+// Lists only allocate when they grow past their high-water mark (allowed by alloc_stats.h).
+// Every list keeps a running hash of its commands, which dl_dedup() uses to drop frames identical to the previous
+// one and to narrow the others down to the area that actually changed.
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include "alloc_stats.h"
+#include "font.h"
+#include "pixfmt.h"
+#include "trace.h"
+
+#define DL_TILE_SIZE    64
+#define DL_MAX_WORKERS  8
+#define DL_PARALLEL_MIN 64 // smaller lists aren't worth waking the workers for
+
+#ifdef DL_STRIDE
+#define DL_ROW_(r, y) (&(r)->pixels[(y) * (DL_STRIDE)])
+#else
+#define DL_ROW_(r, y) (&(r)->pixels[(y) * (r)->width])
+#endif
+
+typedef enum { DL_RECT, DL_CHAR } dl_op_t;
+
+// No padding anywhere: commands are hashed and compared as bytes.
+typedef struct {
+    Uint32 color;  // a px_t
+    Sint16 x, y;
+    Sint16 w, h;   // DL_RECT; already clipped to the target
+    Uint8 op;
+    char c;        // DL_CHAR
+    Uint16 unused;
+} dl_cmd_t;
+
+typedef struct {
+    dl_cmd_t *cmds;
+    int count;
+    int capacity;
+    Uint64 hash;     // FNV-1a over the commands so far
+    SDL_Rect damage; // only rasterize inside this; empty means everywhere
+} dl_list_t;
+
+typedef struct {
+    px_t *pixels;
+    int width;
+    int height;
+
+    // Binning, reused every frame: tile t owns bins[tile_start[t] .. tile_start[t + 1])
+    int tiles_x;
+    int tiles_y;
+    int *tile_start;
+    int *tile_fill;
+    int *bins;
+    int bins_capacity;
+    dl_list_t const *list;
+    SDL_Rect clip;
+
+    // Worker pool
+    SDL_Thread *workers[DL_MAX_WORKERS];
+    int num_workers;
+    SDL_Semaphore *go;
+    SDL_Semaphore *done;
+    SDL_AtomicInt next_tile;
+    SDL_AtomicInt touched;
+    bool quit;
+} dl_raster_t;
+
+static inline bool dl_reserve_(dl_list_t *list, int count) {
+    if (count <= list->capacity) {
+        return true;
+    }
+    const int capacity = SDL_max(count, list->capacity * 2 + 256);
+    ALLOC_ALLOW_BEGIN();
+    dl_cmd_t *cmds = (dl_cmd_t *) SDL_realloc(list->cmds, capacity * sizeof(dl_cmd_t));
+    ALLOC_ALLOW_END();
+    if (!cmds) {
+        return false;
+    }
+    list->cmds = cmds;
+    list->capacity = capacity;
+    return true;
+}
+
+static inline void dl_push_(dl_list_t *list, dl_cmd_t cmd) {
+    if (!dl_reserve_(list, list->count + 1)) {
+        return;
+    }
+    if (list->count == 0) {
+        list->hash = 0xcbf29ce484222325ULL;
+    }
+    Uint8 const *bytes = (Uint8 const *) &cmd;
+    for (size_t i = 0; i < sizeof(cmd); i++) {
+        list->hash = (list->hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    list->cmds[list->count++] = cmd;
+}
+
+static inline void dl_push_rect(dl_list_t *list, int x, int y, int w, int h, px_t color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    dl_push_(list, (dl_cmd_t) {color, (Sint16) x, (Sint16) y, (Sint16) w, (Sint16) h, DL_RECT, 0, 0});
+}
+
+static inline void dl_push_char(dl_list_t *list, int x, int y, char c, px_t color) {
+    if (c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR) {
+        return;
+    }
+    dl_push_(list, (dl_cmd_t) {color, (Sint16) x, (Sint16) y, FONT_WIDTH, FONT_HEIGHT, DL_CHAR, c, 0});
+}
+
+// Drop the recorded commands, keeping the storage.
+static inline void dl_reset(dl_list_t *list) {
+    list->count = 0;
+    list->hash = 0;
+    list->damage = (SDL_Rect) {0, 0, 0, 0};
+}
+
+static inline void dl_free(dl_list_t *list) {
+    SDL_free(list->cmds);
+    SDL_zerop(list);
+}
+
+// Play one command into the pixels inside `clip`. Returns the number of pixels written.
+static inline int dl_execute_(dl_raster_t const *r, dl_cmd_t const *cmd, SDL_Rect const *clip) {
+    const int x0 = SDL_max(cmd->x, clip->x);
+    const int y0 = SDL_max(cmd->y, clip->y);
+    const int x1 = SDL_min(cmd->x + cmd->w, clip->x + clip->w);
+    const int y1 = SDL_min(cmd->y + cmd->h, clip->y + clip->h);
+    if (x1 <= x0 || y1 <= y0) {
+        return 0;
+    }
+
+    const px_t color = (px_t) cmd->color;
+    if (cmd->op == DL_RECT) {
+        for (int py = y0; py < y1; py++) {
+            px_fill(DL_ROW_(r, py) + x0, x1 - x0, color);
+        }
+        return (x1 - x0) * (y1 - y0);
+    }
+
+    int written = 0;
+    uint16_t const *glyph = pixel_font[cmd->c - FONT_FIRST_CHAR];
+    for (int py = y0; py < y1; py++) {
+        const Uint16 bits = (Uint16) (glyph[py - cmd->y] << (x0 - cmd->x)); // column x0 first
+        written += px_glyph_row(DL_ROW_(r, py) + x0, bits, 0, x1 - x0, color);
+    }
+    return written;
+}
+
+static inline void dl_run_tiles_(dl_raster_t *r) {
+    const int num_tiles = r->tiles_x * r->tiles_y;
+    int written = 0;
+    for (int t = SDL_AddAtomicInt(&r->next_tile, 1); t < num_tiles; t = SDL_AddAtomicInt(&r->next_tile, 1)) {
+        const SDL_Rect tile = {
+            (t % r->tiles_x) * DL_TILE_SIZE,
+            (t / r->tiles_x) * DL_TILE_SIZE,
+            SDL_min(DL_TILE_SIZE, r->width - (t % r->tiles_x) * DL_TILE_SIZE),
+            SDL_min(DL_TILE_SIZE, r->height - (t / r->tiles_x) * DL_TILE_SIZE),
+        };
+        SDL_Rect clip;
+        if (!SDL_GetRectIntersection(&tile, &r->clip, &clip)) {
+            continue;
+        }
+        for (int i = r->tile_start[t]; i < r->tile_start[t + 1]; i++) {
+            written += dl_execute_(r, &r->list->cmds[r->bins[i]], &clip);
+        }
+    }
+    SDL_AddAtomicInt(&r->touched, written);
+}
+
+static int SDLCALL dl_worker_(void *data) {
+    dl_raster_t *r = (dl_raster_t *) data;
+    for (;;) {
+        SDL_WaitSemaphore(r->go);
+        if (r->quit) {
+            return 0;
+        }
+        dl_run_tiles_(r);
+        SDL_SignalSemaphore(r->done);
+    }
+}
+
+// `threads` < 0 picks one worker per extra logical core. Falls back to serial rendering if anything fails.
+static inline bool dl_raster_init(dl_raster_t *r, px_t *pixels, int width, int height, int threads) {
+    SDL_zerop(r);
+#ifdef DL_STRIDE
+    SDL_assert(width == DL_STRIDE);
+#endif
+    r->pixels = pixels;
+    r->width = width;
+    r->height = height;
+    r->tiles_x = (width + DL_TILE_SIZE - 1) / DL_TILE_SIZE;
+    r->tiles_y = (height + DL_TILE_SIZE - 1) / DL_TILE_SIZE;
+    r->tile_start = (int *) SDL_calloc(r->tiles_x * r->tiles_y + 1, sizeof(int));
+    r->tile_fill = (int *) SDL_calloc(r->tiles_x * r->tiles_y, sizeof(int));
+    if (!r->tile_start || !r->tile_fill) {
+        return false;
+    }
+
+    if (threads < 0) {
+        threads = SDL_GetNumLogicalCPUCores() - 1;
+    }
+    threads = SDL_clamp(threads, 0, DL_MAX_WORKERS);
+    if (threads > 0) {
+        r->go = SDL_CreateSemaphore(0);
+        r->done = SDL_CreateSemaphore(0);
+    }
+    for (int i = 0; i < threads && r->go && r->done; i++) {
+        r->workers[i] = SDL_CreateThread(dl_worker_, "raster", r);
+        if (!r->workers[i]) {
+            SDL_Log("raster: could not start worker %d: %s", i, SDL_GetError());
+            break;
+        }
+        r->num_workers++;
+    }
+    SDL_Log("raster: %d worker thread(s), %dx%d tiles", r->num_workers, r->tiles_x, r->tiles_y);
+    return true;
+}
+
+static inline void dl_raster_quit(dl_raster_t *r) {
+    r->quit = true;
+    for (int i = 0; i < r->num_workers; i++) {
+        SDL_SignalSemaphore(r->go);
+    }
+    for (int i = 0; i < r->num_workers; i++) {
+        SDL_WaitThread(r->workers[i], NULL);
+    }
+    SDL_DestroySemaphore(r->go);
+    SDL_DestroySemaphore(r->done);
+    SDL_free(r->tile_start);
+    SDL_free(r->tile_fill);
+    SDL_free(r->bins);
+    SDL_zerop(r);
+}
+
+// Counting sort of command indices into the tiles they overlap, preserving order within each tile.
+static inline bool dl_bin_(dl_raster_t *r, dl_list_t const *list) {
+    const int num_tiles = r->tiles_x * r->tiles_y;
+    SDL_memset(r->tile_fill, 0, num_tiles * sizeof(int));
+
+#define DL_FOR_EACH_TILE_(cmd, body)                                                             \
+    do {                                                                                         \
+        const int x0_ = SDL_max((cmd)->x, 0);                                                    \
+        const int y0_ = SDL_max((cmd)->y, 0);                                                    \
+        const int x1_ = SDL_min((cmd)->x + (cmd)->w, r->width);                                  \
+        const int y1_ = SDL_min((cmd)->y + (cmd)->h, r->height);                                 \
+        if (x1_ <= x0_ || y1_ <= y0_) {                                                          \
+            break;                                                                               \
+        }                                                                                        \
+        for (int ty_ = y0_ / DL_TILE_SIZE; ty_ <= (y1_ - 1) / DL_TILE_SIZE; ty_++) {             \
+            for (int tx_ = x0_ / DL_TILE_SIZE; tx_ <= (x1_ - 1) / DL_TILE_SIZE; tx_++) {         \
+                const int tile = ty_ * r->tiles_x + tx_;                                         \
+                body;                                                                            \
+            }                                                                                    \
+        }                                                                                        \
+    } while (0)
+
+    for (int i = 0; i < list->count; i++) {
+        DL_FOR_EACH_TILE_(&list->cmds[i], r->tile_fill[tile]++);
+    }
+    int total = 0;
+    for (int t = 0; t < num_tiles; t++) {
+        r->tile_start[t] = total;
+        total += r->tile_fill[t];
+        r->tile_fill[t] = r->tile_start[t];
+    }
+    r->tile_start[num_tiles] = total;
+
+    if (total > r->bins_capacity) {
+        ALLOC_ALLOW_BEGIN();
+        int *bins = (int *) SDL_realloc(r->bins, total * sizeof(int));
+        ALLOC_ALLOW_END();
+        if (!bins) {
+            return false;
+        }
+        r->bins = bins;
+        r->bins_capacity = total;
+    }
+    for (int i = 0; i < list->count; i++) {
+        DL_FOR_EACH_TILE_(&list->cmds[i], r->bins[r->tile_fill[tile]++] = i);
+    }
+#undef DL_FOR_EACH_TILE_
+    return true;
+}
+
+// Rasterize and empty `list`. Returns the number of pixels written.
+static inline int dl_rasterize(dl_raster_t *r, dl_list_t *list) {
+    if (list->count == 0) {
+        return 0;
+    }
+    TRACE_BEGIN("dl_rasterize");
+    int written = 0;
+    r->clip = (SDL_Rect) {0, 0, r->width, r->height};
+    if (!SDL_RectEmpty(&list->damage)) {
+        SDL_GetRectIntersection(&list->damage, &r->clip, &r->clip);
+    }
+    if (r->num_workers > 0 && list->count >= DL_PARALLEL_MIN && dl_bin_(r, list)) {
+        r->list = list;
+        SDL_SetAtomicInt(&r->next_tile, 0);
+        SDL_SetAtomicInt(&r->touched, 0);
+        for (int i = 0; i < r->num_workers; i++) {
+            SDL_SignalSemaphore(r->go);
+        }
+        dl_run_tiles_(r);
+        for (int i = 0; i < r->num_workers; i++) {
+            SDL_WaitSemaphore(r->done);
+        }
+        r->list = NULL;
+        written = SDL_GetAtomicInt(&r->touched);
+    } else {
+        for (int i = 0; i < list->count; i++) {
+            written += dl_execute_(r, &list->cmds[i], &r->clip);
+        }
+    }
+    dl_reset(list);
+    TRACE_END("dl_rasterize");
+    return written;
+}
+
+//
+// Render thread. The UI thread records a list and hands it over with dl_pipeline_submit(); the render thread
+// rasterizes it while the UI thread goes on with input and the next frame. Lists are double buffered: submit swaps
+// the recorded list with the (empty) one the render thread last finished, so a submitted list is never touched by
+// the UI thread and nothing is copied. One list can be in flight; submitting another waits for it (backpressure).
+// Anything that reads or writes the pixels directly must dl_pipeline_sync() first.
+//
+
+typedef struct {
+    dl_raster_t *raster;
+    dl_list_t in_flight;
+    SDL_Thread *thread;
+    SDL_Semaphore *submitted;
+    SDL_Semaphore *idle; // 1 while the render thread has nothing in flight
+    int written;         // pixels written by the last list
+    bool quit;
+} dl_pipeline_t;
+
+static int SDLCALL dl_pipeline_thread_(void *data) {
+    dl_pipeline_t *p = (dl_pipeline_t *) data;
+    for (;;) {
+        SDL_WaitSemaphore(p->submitted);
+        if (p->quit) {
+            return 0;
+        }
+        p->written = dl_rasterize(p->raster, &p->in_flight);
+        SDL_SignalSemaphore(p->idle);
+    }
+}
+
+// Without a thread (`threaded` false, or it failed to start) submit simply rasterizes on the caller's thread.
+static inline bool dl_pipeline_start(dl_pipeline_t *p, dl_raster_t *raster, bool threaded) {
+    SDL_zerop(p);
+    p->raster = raster;
+    if (!threaded) {
+        return true;
+    }
+    p->submitted = SDL_CreateSemaphore(0);
+    p->idle = SDL_CreateSemaphore(1);
+    if (!p->submitted || !p->idle) {
+        return false;
+    }
+    p->thread = SDL_CreateThread(dl_pipeline_thread_, "render", p);
+    if (!p->thread) {
+        SDL_Log("raster: could not start render thread: %s", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+// Wait until the last submitted list is in the pixels. Returns how many pixels it wrote (once; 0 afterwards).
+static inline int dl_pipeline_sync(dl_pipeline_t *p) {
+    if (!p->thread) {
+        return 0;
+    }
+    TRACE_BEGIN("dl_pipeline_sync");
+    SDL_WaitSemaphore(p->idle);
+    const int written = p->written;
+    p->written = 0;
+    SDL_SignalSemaphore(p->idle);
+    TRACE_END("dl_pipeline_sync");
+    return written;
+}
+
+// True when nothing is in flight, without waiting.
+static inline bool dl_pipeline_idle(dl_pipeline_t *p) {
+    if (!p->thread) {
+        return true;
+    }
+    if (!SDL_TryWaitSemaphore(p->idle)) {
+        return false;
+    }
+    SDL_SignalSemaphore(p->idle);
+    return true;
+}
+
+// Hand `list` to the render thread and give the caller back an empty one. Returns the pixels written by the
+// previous list if this had to wait for it, or by `list` itself when there is no render thread.
+static inline int dl_pipeline_submit(dl_pipeline_t *p, dl_list_t *list) {
+    if (!p->thread) {
+        return dl_rasterize(p->raster, list);
+    }
+    if (list->count == 0) {
+        return 0;
+    }
+    TRACE_BEGIN("dl_pipeline_submit");
+    SDL_WaitSemaphore(p->idle);
+    const int written = p->written;
+    p->written = 0;
+    const dl_list_t recorded = *list;
+    *list = p->in_flight;
+    p->in_flight = recorded;
+    SDL_SignalSemaphore(p->submitted);
+    TRACE_END("dl_pipeline_submit");
+    return written;
+}
+
+static inline void dl_pipeline_stop(dl_pipeline_t *p) {
+    if (p->thread) {
+        SDL_WaitSemaphore(p->idle);
+        p->quit = true;
+        SDL_SignalSemaphore(p->submitted);
+        SDL_WaitThread(p->thread, NULL);
+    }
+    SDL_DestroySemaphore(p->submitted);
+    SDL_DestroySemaphore(p->idle);
+    dl_free(&p->in_flight);
+    SDL_zerop(p);
+}
+
+//
+// Frame deduplication. Keeps a copy of the last full frame. A new frame with the same hash is dropped; otherwise the
+// commands are compared to find the first one that differs, and everything either frame draws from there on is the
+// damage: outside it both frames are painted by the same common prefix, so only the damage needs rasterizing (still
+// with the whole list, clipped) and presenting.
+//
+
+typedef struct {
+    dl_list_t last;
+    bool valid;
+} dl_dedup_t;
+
+static inline void dl_bounds_(dl_cmd_t const *cmds, int first, int count, SDL_Rect *bounds) {
+    for (int i = first; i < count; i++) {
+        const SDL_Rect r = {cmds[i].x, cmds[i].y, cmds[i].w, cmds[i].h};
+        SDL_GetRectUnion(bounds, &r, bounds);
+    }
+}
+
+// Returns false if `list` draws exactly the previous frame. Otherwise sets list->damage (everything when there is no
+// usable previous frame) and remembers `list` as the new previous frame.
+static inline bool dl_dedup(dl_dedup_t *d, dl_list_t *list, int width, int height) {
+    const SDL_Rect all = {0, 0, width, height};
+    if (d->valid && list->count == d->last.count && list->hash == d->last.hash) {
+        return false;
+    }
+
+    list->damage = all;
+    if (d->valid) {
+        int first = 0;
+        const int common = SDL_min(list->count, d->last.count);
+        while (first < common && SDL_memcmp(&list->cmds[first], &d->last.cmds[first], sizeof(dl_cmd_t)) == 0) {
+            first++;
+        }
+        SDL_Rect damage = {0, 0, 0, 0};
+        dl_bounds_(list->cmds, first, list->count, &damage);
+        dl_bounds_(d->last.cmds, first, d->last.count, &damage);
+        if (!SDL_GetRectIntersection(&damage, &all, &list->damage)) {
+            list->damage = (SDL_Rect) {0, 0, 0, 0};
+        }
+    }
+
+    d->valid = dl_reserve_(&d->last, list->count);
+    if (d->valid) {
+        SDL_memcpy(d->last.cmds, list->cmds, list->count * sizeof(dl_cmd_t));
+        d->last.count = list->count;
+        d->last.hash = list->hash;
+    }
+    return !SDL_RectEmpty(&list->damage);
+}
+
+// Forget the previous frame, so the next one is drawn in full (after something else painted over the pixels).
+static inline void dl_dedup_invalidate(dl_dedup_t *d) {
+    d->valid = false;
+}
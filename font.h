@@ -1,3 +1,5 @@
+#pragma once
+
 #include <stdint.h>
 
 #define FONT_WIDTH      12
@@ -0,0 +1,306 @@
+//
+// State history: when each tracked thing (a space, keyed by a 32-bit hash) was open, closed or unobserved, in
+// HISTORY_SLOT_S slots over the last HISTORY_SLOTS of them.
+//
+// In memory every track is a ring of 2-bit slot states plus the run it is in right now. On flash it is an
+// append-only log of finished runs, 8 bytes each and written in batches, so a space that changes state twice a day
+// costs about 16 bytes a day. Replaying the log rebuilds the rings; when it holds runs that have fallen out of the
+// window, history_load() rewrites it from the rings.
+//
+//     Record, 8 bytes:   u32 key  u32 (start slot << 12 | (length - 1) << 1 | open)
+//
+// Slots count from HISTORY_EPOCH. A gap of more than HISTORY_GAP_SLOTS between observations is left unknown.
+// Until the wall clock is set (history_slot_now() < 0) nothing can be loaded or observed.
+//
+//     const int track = history_track(&history, key);
+//     history_observe(&history, track, history_slot_now(), is_open);
+//     ...
+//     history_flush(&history, path, false); // on a timer, and with true on exit
+//
+
+#pragma once
+
+#include <stdio.h>
+
+#include <SDL3/SDL.h>
+
+#define HISTORY_EPOCH      1735689600 // 2025-01-01T00:00:00Z
+#define HISTORY_SLOT_S     (30 * 60)
+#define HISTORY_SLOTS      (28 * 48)  // four weeks
+#define HISTORY_GAP_SLOTS  2
+#define HISTORY_RUN_MAX    2048       // longest run one record can hold
+#define HISTORY_SKEW_SLOTS 2          // how far in the future a loaded run may start, for clock corrections
+#define HISTORY_RECORD     8
+
+typedef enum {
+    HISTORY_UNKNOWN,
+    HISTORY_CLOSED,
+    HISTORY_OPEN,
+} history_state_e;
+
+typedef struct {
+    Uint32 key;
+    Sint32 horizon;   // newest slot in the ring, -1 if none
+    Sint32 run_start; // current run, length 0 if none
+    Sint32 run_length;
+    bool run_open;
+    Uint8 ring[HISTORY_SLOTS / 4];
+} history_track_t;
+
+typedef struct {
+    history_track_t *tracks;
+    int count;
+    int capacity;
+    Uint8 *pending; // finished runs not written yet
+    size_t pending_size;
+    size_t pending_capacity;
+} history_t;
+
+// Negative while the wall clock isn't set (before HISTORY_EPOCH)
+static inline Sint32 history_slot_now(void) {
+    SDL_Time now = 0;
+    SDL_GetCurrentTime(&now);
+    return (Sint32) ((now / SDL_NS_PER_SECOND - HISTORY_EPOCH) / HISTORY_SLOT_S);
+}
+
+static inline void history_destroy(history_t *h) {
+    SDL_free(h->tracks);
+    SDL_free(h->pending);
+    SDL_zerop(h);
+}
+
+// Index of the track for `key`, created if there is none. -1 if out of memory.
+static inline int history_track(history_t *h, const Uint32 key) {
+    for (int i = 0; i < h->count; i++) {
+        if (h->tracks[i].key == key) {
+            return i;
+        }
+    }
+    if (h->count == h->capacity) {
+        const int capacity = SDL_max(16, h->capacity * 2);
+        history_track_t *tracks = (history_track_t *) SDL_realloc(h->tracks, capacity * sizeof(history_track_t));
+        if (!tracks) {
+            return -1;
+        }
+        h->tracks = tracks;
+        h->capacity = capacity;
+    }
+    history_track_t *track = &h->tracks[h->count];
+    SDL_zerop(track);
+    track->key = key;
+    track->horizon = -1;
+    return h->count++;
+}
+
+static inline history_state_e history_state_at(history_track_t const *track, const Sint32 slot) {
+    if (slot < 0 || slot > track->horizon || slot <= track->horizon - HISTORY_SLOTS) {
+        return HISTORY_UNKNOWN;
+    }
+    const int i = slot % HISTORY_SLOTS;
+    return (history_state_e) ((track->ring[i / 4] >> (2 * (i % 4))) & 3);
+}
+
+static inline void history_set_(history_track_t *track, const Sint32 slot, const history_state_e state) {
+    if (slot < 0 || slot <= track->horizon - HISTORY_SLOTS) {
+        return;
+    }
+    // Moving the horizon forward forgets whatever the ring held for the slots skipped over
+    for (Sint32 s = SDL_max(track->horizon + 1, slot - HISTORY_SLOTS + 1); s < slot; s++) {
+        const int i = s % HISTORY_SLOTS;
+        track->ring[i / 4] &= (Uint8) ~(3 << (2 * (i % 4)));
+    }
+    track->horizon = SDL_max(track->horizon, slot);
+    const int i = slot % HISTORY_SLOTS;
+    track->ring[i / 4] = (Uint8) ((track->ring[i / 4] & ~(3 << (2 * (i % 4)))) | (state << (2 * (i % 4))));
+}
+
+static inline void history_apply_(history_track_t *track, const Sint32 start, const Sint32 length, const bool open) {
+    for (Sint32 s = SDL_max(start, start + length - HISTORY_SLOTS); s < start + length; s++) {
+        history_set_(track, s, open ? HISTORY_OPEN : HISTORY_CLOSED);
+    }
+}
+
+static inline void history_put_u32_(Uint8 *p, const Uint32 value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (Uint8) (value >> (8 * i));
+    }
+}
+
+static inline Uint32 history_get_u32_(Uint8 const *p) {
+    return (Uint32) p[0] | ((Uint32) p[1] << 8) | ((Uint32) p[2] << 16) | ((Uint32) p[3] << 24);
+}
+
+// Queue the track's current run for the next flush and close it
+static inline void history_end_run_(history_t *h, history_track_t *track) {
+    if (track->run_length == 0) {
+        return;
+    }
+    if (h->pending_size + HISTORY_RECORD > h->pending_capacity) {
+        const size_t capacity = SDL_max((size_t) 256, h->pending_capacity * 2);
+        Uint8 *pending = (Uint8 *) SDL_realloc(h->pending, capacity);
+        if (!pending) {
+            return; // the run stays in memory, it just won't survive a restart
+        }
+        h->pending = pending;
+        h->pending_capacity = capacity;
+    }
+    Uint8 *record = &h->pending[h->pending_size];
+    history_put_u32_(record, track->key);
+    history_put_u32_(
+        &record[4], ((Uint32) track->run_start << 12) | ((Uint32) (track->run_length - 1) << 1) | track->run_open
+    );
+    h->pending_size += HISTORY_RECORD;
+    track->run_length = 0;
+}
+
+// Record that the track was seen open or closed in `slot`; ignored if the slot is negative (clock not set)
+static inline void history_observe(history_t *h, const int index, const Sint32 slot, const bool open) {
+    if (slot < 0) {
+        return; // a run starting there would be written as one a million slots in the future
+    }
+    history_track_t *track = &h->tracks[index];
+    const Sint32 run_end = track->run_start + track->run_length; // first slot after the run
+    if (track->run_length > 0 && track->run_open == open && slot >= run_end - 1 &&
+        slot <= run_end + HISTORY_GAP_SLOTS && slot - track->run_start < HISTORY_RUN_MAX) {
+        // Still the same: the run (and whatever short gap there was) now reaches this slot
+        for (Sint32 s = run_end; s <= slot; s++) {
+            history_set_(track, s, open ? HISTORY_OPEN : HISTORY_CLOSED);
+        }
+        track->run_length = SDL_max(track->run_length, slot - track->run_start + 1);
+        return;
+    }
+    if (track->run_length > 0 && slot < run_end) {
+        // Changed within the run's last slot (or the clock went back): the new state takes over from here
+        track->run_length = SDL_max(0, slot - track->run_start);
+    }
+    history_end_run_(h, track);
+    track->run_start = slot;
+    track->run_length = 1;
+    track->run_open = open;
+    history_set_(track, slot, open ? HISTORY_OPEN : HISTORY_CLOSED);
+}
+
+// Append the queued runs to `path`; with `final` also the runs still going on. False if the file can't be written.
+static inline bool history_flush(history_t *h, char const *path, const bool final) {
+    if (final) {
+        for (int i = 0; i < h->count; i++) {
+            history_end_run_(h, &h->tracks[i]);
+        }
+    }
+    if (h->pending_size == 0) {
+        return true;
+    }
+    FILE *f = fopen(path, "ab");
+    if (!f) {
+        return false;
+    }
+    const bool ok = fwrite(h->pending, 1, h->pending_size, f) == h->pending_size;
+    fclose(f);
+    if (ok) {
+        h->pending_size = 0;
+    }
+    return ok;
+}
+
+// Rewrite `path` as the runs in the rings, dropping everything older than the window
+static inline void history_compact_(history_t *h, char const *path) {
+    Uint8 const *pending = h->pending;
+    const size_t pending_size = h->pending_size;
+    h->pending = NULL;
+    h->pending_size = h->pending_capacity = 0;
+    for (int i = 0; i < h->count; i++) {
+        history_track_t *track = &h->tracks[i];
+        const Sint32 run_start = track->run_start, run_length = track->run_length;
+        const bool run_open = track->run_open;
+        track->run_length = 0;
+        for (Sint32 s = SDL_max(0, track->horizon - HISTORY_SLOTS + 1); s <= track->horizon; s++) {
+            const history_state_e state = history_state_at(track, s);
+            const bool open = state == HISTORY_OPEN;
+            if (state == HISTORY_UNKNOWN || (track->run_length > 0 && (open != track->run_open ||
+                                                                       track->run_length == HISTORY_RUN_MAX))) {
+                history_end_run_(h, track);
+            }
+            if (state != HISTORY_UNKNOWN) {
+                if (track->run_length == 0) {
+                    track->run_start = s;
+                    track->run_open = open;
+                }
+                track->run_length++;
+            }
+        }
+        history_end_run_(h, track);
+        track->run_start = run_start;
+        track->run_length = run_length;
+        track->run_open = run_open;
+    }
+    FILE *f = fopen(path, "wb");
+    if (f) {
+        fwrite(h->pending, 1, h->pending_size, f);
+        fclose(f);
+    }
+    SDL_free(h->pending);
+    h->pending = (Uint8 *) pending;
+    h->pending_size = h->pending_capacity = pending_size;
+}
+
+// Replay `path` into the tracks that exist (records for other keys, out of the window or from the future are dropped
+// by the next compaction). False, with nothing loaded, while the clock isn't set: call again once it is.
+static inline bool history_load(history_t *h, char const *path) {
+    const Sint32 now = history_slot_now();
+    if (now < 0) {
+        return false;
+    }
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return true;
+    }
+    const Sint32 oldest = now - HISTORY_SLOTS;
+    int stale = 0;
+    Uint8 record[HISTORY_RECORD];
+    int last = -1;
+    while (fread(record, 1, HISTORY_RECORD, f) == HISTORY_RECORD) {
+        const Uint32 key = history_get_u32_(record);
+        const Uint32 run = history_get_u32_(&record[4]);
+        const Sint32 start = (Sint32) (run >> 12);
+        const Sint32 length = (Sint32) ((run >> 1) & (HISTORY_RUN_MAX - 1)) + 1;
+        if (last < 0 || h->tracks[last].key != key) {
+            last = -1;
+            for (int i = 0; i < h->count; i++) {
+                if (h->tracks[i].key == key) {
+                    last = i;
+                    break;
+                }
+            }
+        }
+        if (last < 0 || start + length <= oldest || start > now + HISTORY_SKEW_SLOTS) {
+            stale++;
+            continue;
+        }
+        history_apply_(&h->tracks[last], start, length, run & 1);
+    }
+    fclose(f);
+    if (stale > 0) {
+        history_compact_(h, path);
+    }
+    return true;
+}
+
+// How often the track was open in each hour of the week (local time, `utc_offset` seconds east of UTC, Sunday
+// first): known[] slots observed, open[] of those open. Covers the whole window.
+static inline void history_week_profile(
+    history_track_t const *track, const int utc_offset, Uint16 known[7 * 24], Uint16 open[7 * 24]
+) {
+    SDL_memset(known, 0, 7 * 24 * sizeof(Uint16));
+    SDL_memset(open, 0, 7 * 24 * sizeof(Uint16));
+    for (Sint32 s = SDL_max(0, track->horizon - HISTORY_SLOTS + 1); s <= track->horizon; s++) {
+        const history_state_e state = history_state_at(track, s);
+        if (state == HISTORY_UNKNOWN) {
+            continue;
+        }
+        const Sint64 local = (Sint64) HISTORY_EPOCH + (Sint64) s * HISTORY_SLOT_S + utc_offset;
+        const int day = (int) ((local / 86400 + 4) % 7); // 1970-01-01 was a Thursday
+        const int hour = (int) (local % 86400 / 3600);
+        known[day * 24 + hour]++;
+        open[day * 24 + hour] += state == HISTORY_OPEN;
+    }
+}
@@ -14,11 +14,17 @@
 #include <SDL3/SDL_filesystem.h>
 
 #include "font.h"
+#include "trace.h"
+#include "alloc_stats.h"
+#include "watchdog.h"
+#include "replay.h"
 #include "stdlib.h"
 
 #ifdef WHY_BADGE
 #include "badgevms/device.h" // needed for orientation sensor
+#include "badgevms/process.h" // needed for get_num_tasks
 #include "sys/unistd.h" // needed for sleep
+#include <malloc.h> // needed for mallinfo
 #endif
 
 #define WINDOW_WIDTH     720
@@ -30,6 +36,9 @@
 #define WINDOW_FLAGS     0
 #endif
 
+#define DL_STRIDE WINDOW_WIDTH
+#include "displaylist.h"
+
 #define CDE_BG_COLOR      0x9CA0A0
 #define CDE_PANEL_COLOR   0xAEB2B2
 #define CDE_BORDER_LIGHT  0xFFFFFF
@@ -60,6 +69,45 @@ static const char *pathtype_to_str(SDL_PathType t) {
     }
 }
 
+// Retained widgets. A screen builds its widgets once, then only updates their properties; every change
+// invalidates what the widget covered before and after, and ui_render() repaints just that area.
+#define UI_MAX_WIDGETS 16
+#define UI_TEXT_MAX    128
+
+typedef enum { UI_WINDOW, UI_LABEL, UI_LIST, UI_SCROLLBAR, UI_PROGRESS } UiKind;
+
+enum {
+    UI_BOLD = 1,
+    UI_CENTERED = 2, // centered in rect.w
+};
+
+// Fills the three text lines of list row `index`.
+typedef void (*UiRowFn)(void *userdata, int index, char lines[3][UI_TEXT_MAX]);
+
+typedef struct {
+    UiKind kind;
+    bool visible;
+    SDL_Rect rect;
+    Uint32 color;
+    int flags;
+    char text[UI_TEXT_MAX]; // window title or label text
+    // List: count rows, `selected` highlighted, first shown row `offset`.
+    // Scrollbar: count total, perPage visible, at `offset`. Progress: `selected` out of `count`.
+    int count;
+    int selected;
+    int offset;
+    int perPage;
+    int rowHeight;
+    UiRowFn rowText;
+    void *userdata;
+} UiWidget;
+
+typedef struct {
+    UiWidget widgets[UI_MAX_WIDGETS]; // in paint order: the window first
+    int count;
+    SDL_Rect damage;
+} UiScreen;
+
 typedef enum {
     WELCOME_SCREEN,
     MENU_SCREEN,
@@ -72,6 +120,7 @@ typedef enum {
 typedef struct {
     bool showWelcomeScreenDesc;
     Uint64 lastChange;
+    UiScreen ui;
 } WelcomeScreenContext;
 
 typedef struct {
@@ -90,13 +139,10 @@ typedef struct {
     int total_items;
     int items_per_page;
     MenuScreenOption_t menu_options[MENU_COUNT];
-    bool shouldRepaint;
-    Uint16 lastChange;
+    UiScreen ui;
 } MenuScreenContext;
 
 typedef struct {
-    bool shouldRepaint;
-    Uint16 lastChange;
     char *currentDirectory[4096];
     char **entries;
     int scroll_offset;
@@ -104,21 +150,24 @@ typedef struct {
     int total_items;
     int items_per_page;
     // Add other fields as needed for file explorer
+    UiScreen ui;
 } FilesScreenContext;
 
 typedef struct {
-    bool shouldRepaint;
-    Uint16 lastChange;
     int latestScancode;
+    UiScreen ui;
 } KeyboardScreenContext;
 
 typedef struct {
-    bool shouldRepaint;
-    Uint16 lastChange;
     void *orientationSensor;
     void *gasSensor;
+    UiScreen ui;
 } SensorsScreenContext;
 
+typedef struct {
+    UiScreen ui;
+} AboutScreenContext;
+
 typedef struct {
     int currentScreen;
     WelcomeScreenContext *welcomeScreenCtx;
@@ -126,14 +175,45 @@ typedef struct {
     KeyboardScreenContext *keyboardScreenCtx;
     FilesScreenContext *filesScreenCtx;
     SensorsScreenContext *sensorsScreenCtx;
+    AboutScreenContext *aboutScreenCtx;
 } RandomAppContext;
 
+#define HUD_SAMPLES   120
+#define HUD_W         262
+#define HUD_H         160
+#define HUD_X         (WINDOW_WIDTH - HUD_W - 6)
+#define HUD_Y         6
+#define HUD_REFRESH_NS (250 * SDL_NS_PER_MS)
+
+// Performance overlay (F3). The text is only re-rendered a few times per second and cached in
+// `cache`; frames presented in between get the cached copy blitted on top.
+typedef struct {
+    bool visible;
+    Uint64 lastDraw;
+    Uint64 lastIterate;
+    float workMs[HUD_SAMPLES];
+    int sample;
+    float intervalMs;
+    Uint64 pixelsTouched; // bumped by the rasterizer, reset every iteration
+    Uint64 pixelsLastFrame;
+    px_t cache[HUD_W * HUD_H];
+} PerfHud;
+
 typedef struct {
     SDL_Window *window;
     SDL_Renderer *renderer;
     SDL_Texture *framebuffer;
-    Uint16 *pixels;
+    SDL_PixelFormat textureFormat; // PX_FORMAT, unless the renderer can't take it
+    px_t *pixels; // in the build's pixel format, see pixfmt.h
+    dl_list_t frame; // draw calls not submitted for rasterization yet
+    dl_raster_t raster;
+    dl_pipeline_t pipeline;
+    dl_dedup_t dedup;
+    bool presentPending; // submitted, waiting for the render thread before it can be uploaded
+    SDL_Rect presentRect;
+    UiScreen const *uiShown; // whose widgets are in `pixels`
     RandomAppContext *appCtx;
+    PerfHud hud;
 } AppState;
 
 static const struct {
@@ -146,15 +226,50 @@ static const struct {
     {SDL_PROP_APP_METADATA_TYPE_STRING, "tool"}
 };
 
-static Uint16 rgb888_to_rgb565(const Uint32 rgb888) {
-    const Uint8 r = (rgb888 >> 16) & 0xFF;
-    const Uint8 g = (rgb888 >> 8) & 0xFF;
-    const Uint8 b = rgb888 & 0xFF;
-    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+#ifdef ENABLE_INDEX8
+// The UI's colors get exact palette entries, black first to match a zeroed buffer.
+static const Uint32 ui_palette_[] = {
+    CDE_TEXT_COLOR, CDE_BG_COLOR, CDE_PANEL_COLOR, CDE_BORDER_LIGHT, CDE_BORDER_DARK, CDE_SELECTED_BG,
+    CDE_BUTTON_COLOR, CDE_TITLE_BG, CDE_PROGRESS_BG, CDE_SUCCESS_COLOR, CDE_ERROR_COLOR,
+};
+#endif
+
+// Pick the streaming texture format: the render format itself when the renderer takes it, so frames upload
+// without any conversion; otherwise whichever of RGB565 / XRGB8888 the renderer lists first (its preference),
+// expanded into on upload. Indexed pixels always need that expansion.
+static SDL_PixelFormat choose_texture_format_(SDL_PixelFormat const *formats) {
+    if (!formats) {
+        return PX_FORMAT == SDL_PIXELFORMAT_INDEX8 ? SDL_PIXELFORMAT_RGB565 : PX_FORMAT;
+    }
+    for (int i = 0; formats[i] != SDL_PIXELFORMAT_UNKNOWN; i++) {
+        if (formats[i] == PX_FORMAT) {
+            return PX_FORMAT;
+        }
+    }
+    for (int i = 0; formats[i] != SDL_PIXELFORMAT_UNKNOWN; i++) {
+        if (formats[i] == SDL_PIXELFORMAT_RGB565 || formats[i] == SDL_PIXELFORMAT_XRGB8888) {
+            return formats[i];
+        }
+    }
+    // Nothing we can write; let the renderer convert
+    return PX_FORMAT == SDL_PIXELFORMAT_INDEX8 ? SDL_PIXELFORMAT_RGB565 : PX_FORMAT;
+}
+
+// Expand `rect` of the framebuffer to RGB565 at `dst`.
+static void pixels_to_rgb565_(px_t const *pixels, SDL_Rect const *rect, void *dst, int pitch) {
+    for (int y = 0; y < rect->h; y++) {
+        px_row_to_rgb565((Uint16 *) ((Uint8 *) dst + y * pitch), &pixels[(rect->y + y) * WINDOW_WIDTH + rect->x], rect->w);
+    }
+}
+
+static void pixels_to_xrgb8888_(px_t const *pixels, SDL_Rect const *rect, void *dst, int pitch) {
+    for (int y = 0; y < rect->h; y++) {
+        px_row_to_xrgb8888((Uint32 *) ((Uint8 *) dst + y * pitch), &pixels[(rect->y + y) * WINDOW_WIDTH + rect->x], rect->w);
+    }
 }
 
 void draw_rect(AppState *ctx, int x, int y, int w, int h, Uint32 color) {
-    Uint16 rgb565 = rgb888_to_rgb565(color);
+    const px_t pixel = px_encode(color);
     int x2 = x + w;
     int y2 = y + h;
 
@@ -167,40 +282,22 @@ void draw_rect(AppState *ctx, int x, int y, int w, int h, Uint32 color) {
     if (y2 > WINDOW_HEIGHT)
         y2 = WINDOW_HEIGHT;
 
-    for (int py = y; py < y2; py++) {
-        Uint16 *row = &ctx->pixels[py * WINDOW_WIDTH + x];
-        int width = x2 - x;
-        for (int i = 0; i < width; i++) {
-            row[i] = rgb565;
-        }
-    }
+    dl_push_rect(&ctx->frame, x, y, x2 - x, y2 - y, pixel);
 }
 
 void draw_char(AppState *ctx, int x, int y, char c, Uint32 color) {
     if (c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR)
         return;
+    if (x <= -FONT_WIDTH || x >= WINDOW_WIDTH || y <= -FONT_HEIGHT || y >= WINDOW_HEIGHT)
+        return;
 
-    int char_index = c - FONT_FIRST_CHAR;
-    uint16_t const *char_data = pixel_font[char_index];
-    Uint16 rgb565 = rgb888_to_rgb565(color);
-
-    for (int row = 0; row < FONT_HEIGHT; row++) {
-        const uint16_t row_data = char_data[row];
-        const int py = y + row;
-
-        if (py < 0 || py >= WINDOW_HEIGHT)
-            continue;
+    dl_push_char(&ctx->frame, x, y, c, px_encode(color));
+}
 
-        for (int col = 0; col < FONT_WIDTH; col++) {
-            if (row_data & (0x800 >> col)) {
-                // Check bit from MSB
-                int px = x + col;
-                if (px >= 0 && px < WINDOW_WIDTH) {
-                    ctx->pixels[py * WINDOW_WIDTH + px] = rgb565;
-                }
-            }
-        }
-    }
+// Get everything drawn so far into `pixels`; needed before touching them directly.
+static void flush_frame_(AppState *ctx) {
+    ctx->hud.pixelsTouched += dl_pipeline_submit(&ctx->pipeline, &ctx->frame);
+    ctx->hud.pixelsTouched += dl_pipeline_sync(&ctx->pipeline);
 }
 
 void draw_text(AppState *ctx, int x, int y, char const *text, Uint32 color) {
@@ -239,187 +336,484 @@ void draw_3d_border(AppState *ctx, int x, int y, int w, int h, int inset) {
     draw_rect(ctx, x + w - 3, y, 3, h, dark_color);
 }
 
-void welcome_screen_logic(AppState *ctx) {
-    if (ctx->appCtx->currentScreen != WELCOME_SCREEN) {
-        return;
-    }
+static void hud_render_(AppState *ctx) {
+    PerfHud *hud = &ctx->hud;
+    flush_frame_(ctx);
+    const Uint64 touched = hud->pixelsTouched; // the overlay itself doesn't count
 
-    // Don't render screen if nothing changed.
-    bool shouldRender = false;
-    //First time here?
-    if (ctx->appCtx->welcomeScreenCtx->lastChange == 0) {
-        //Then initialize
-        ctx->appCtx->welcomeScreenCtx->lastChange = SDL_GetTicks();
-        ctx->appCtx->welcomeScreenCtx->showWelcomeScreenDesc = true;
-        shouldRender = true; //repaint
+    float worst = 0.0f;
+    for (int i = 0; i < HUD_SAMPLES; i++) {
+        if (hud->workMs[i] > worst)
+            worst = hud->workMs[i];
     }
+    const int last = (hud->sample + HUD_SAMPLES - 1) % HUD_SAMPLES;
 
-    const int blink_interval = 500; // milliseconds
-    const Uint64 now = SDL_GetTicks();
-    if (now - ctx->appCtx->welcomeScreenCtx->lastChange >= blink_interval) {
-        ctx->appCtx->welcomeScreenCtx->showWelcomeScreenDesc = !ctx->appCtx->welcomeScreenCtx->showWelcomeScreenDesc;
-        ctx->appCtx->welcomeScreenCtx->lastChange = now;
-        shouldRender = true; //repaint
+    char lines[5][48];
+    SDL_snprintf(lines[0], sizeof(lines[0]), "frame %6.2fms max %6.2f", hud->workMs[last], worst);
+    SDL_snprintf(lines[1], sizeof(lines[1]), "fps %7.1f  px %8" SDL_PRIu64,
+                 hud->intervalMs > 0.0f ? 1000.0f / hud->intervalMs : 0.0f, hud->pixelsLastFrame);
+#ifdef WHY_BADGE
+    struct mallinfo mi = mallinfo();
+    SDL_snprintf(lines[2], sizeof(lines[2]), "heap %8u KB", (unsigned) (mi.uordblks / 1024));
+    SDL_snprintf(lines[3], sizeof(lines[3]), "tasks %3u", (unsigned) get_num_tasks());
+#else
+    SDL_snprintf(lines[2], sizeof(lines[2]), "SDL allocs %6d", SDL_GetNumAllocations());
+    SDL_snprintf(lines[3], sizeof(lines[3]), "tasks n/a");
+#endif
+    watchdog_stall_t stall;
+    if (watchdog_worst_stall(0, &stall)) {
+        SDL_snprintf(lines[4], sizeof(lines[4]), "stall %5ums %.9s", stall.frame_ms, stall.section);
+    } else {
+        SDL_snprintf(lines[4], sizeof(lines[4]), "stall -");
     }
 
-    if (!shouldRender) {
-        return;
+    draw_rect(ctx, HUD_X, HUD_Y, HUD_W, HUD_H, CDE_TEXT_COLOR);
+    for (int i = 0; i < (int) SDL_arraysize(lines); i++) {
+        draw_text(ctx, HUD_X + 4, HUD_Y + 2 + i * FONT_HEIGHT, lines[i], CDE_SELECTED_TEXT);
     }
 
-    const int window_x = 30;
-    const int window_y = 30;
-    const int window_w = WINDOW_WIDTH - 60;
-    const int window_h = WINDOW_HEIGHT - 60;
-
-    draw_rect(ctx, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, CDE_BG_COLOR);
-
-    draw_rect(ctx, window_x, window_y, window_w, window_h, CDE_PANEL_COLOR);
-    draw_3d_border(ctx, window_x, window_y, window_w, window_h, 0);
+    // Sparkline: one 2px column per frame, oldest left; full height is two 60Hz frames, the line is one.
+    const int graph_y = HUD_Y + HUD_H - 36;
+    const int graph_h = 32;
+    const float full_scale_ms = 2.0f * 1000.0f / 60.0f;
+    draw_rect(ctx, HUD_X + 10, graph_y + graph_h / 2, HUD_SAMPLES * 2, 1, CDE_BORDER_DARK);
+    for (int i = 0; i < HUD_SAMPLES; i++) {
+        const float ms = hud->workMs[(hud->sample + i) % HUD_SAMPLES];
+        int h = (int) (ms / full_scale_ms * graph_h + 0.5f);
+        if (h > graph_h)
+            h = graph_h;
+        if (h < 1)
+            h = 1;
+        const Uint32 color = ms * 2.0f > full_scale_ms ? CDE_ERROR_COLOR : CDE_SUCCESS_COLOR;
+        draw_rect(ctx, HUD_X + 10 + i * 2, graph_y + graph_h - h, 2, h, color);
+    }
 
-    const int title_h = 45;
-    draw_rect(ctx, window_x + 3, window_y + 3, window_w - 6, title_h, CDE_TITLE_BG);
-    draw_text_bold(ctx, window_x + 15, window_y + 11, "Random App - Welcome", CDE_SELECTED_TEXT);
+    flush_frame_(ctx);
+    for (int row = 0; row < HUD_H; row++) {
+        px_copy(&hud->cache[row * HUD_W], &ctx->pixels[(HUD_Y + row) * WINDOW_WIDTH + HUD_X], HUD_W);
+    }
+    hud->pixelsTouched = touched;
+    hud->lastDraw = SDL_GetTicksNS();
+}
 
-    int content_y = window_y + window_h / 2;
+static void hud_blit_(AppState *ctx) {
+    for (int row = 0; row < HUD_H; row++) {
+        px_copy(&ctx->pixels[(HUD_Y + row) * WINDOW_WIDTH + HUD_X], &ctx->hud.cache[row * HUD_W], HUD_W);
+    }
+}
 
-    if (ctx->appCtx->welcomeScreenCtx->showWelcomeScreenDesc) {
-        draw_text_centered(ctx, window_x, content_y, window_w, "Press any key to continue...", CDE_TEXT_COLOR);
+// Wait for the pending frame to be rasterized, then upload and present it. The SDL renderer belongs to this
+// (main) thread, so only rasterization runs on the render thread.
+static void present_pending_(AppState *ctx) {
+    if (!ctx->presentPending) {
+        return;
+    }
+    ctx->presentPending = false;
+    TRACE_BEGIN("present_frame");
+    ctx->hud.pixelsTouched += dl_pipeline_sync(&ctx->pipeline);
+    if (ctx->hud.visible) {
+        hud_blit_(ctx);
     }
-    // Render everything
+    SDL_Rect const *rect = &ctx->presentRect;
     SDL_RenderClear(ctx->renderer);
-    SDL_UpdateTexture(ctx->framebuffer, NULL, ctx->pixels, WINDOW_WIDTH * sizeof(Uint16));
+    if (ctx->textureFormat == PX_FORMAT) {
+        SDL_UpdateTexture(ctx->framebuffer, rect, &ctx->pixels[rect->y * WINDOW_WIDTH + rect->x], WINDOW_WIDTH * sizeof(px_t));
+    } else {
+        // Convert straight into the texture's memory, only for this rectangle
+        void *texels;
+        int pitch;
+        if (SDL_LockTexture(ctx->framebuffer, rect, &texels, &pitch)) {
+            if (ctx->textureFormat == SDL_PIXELFORMAT_RGB565) {
+                pixels_to_rgb565_(ctx->pixels, rect, texels, pitch);
+            } else {
+                pixels_to_xrgb8888_(ctx->pixels, rect, texels, pitch);
+            }
+            SDL_UnlockTexture(ctx->framebuffer);
+        }
+    }
     SDL_RenderTexture(ctx->renderer, ctx->framebuffer, NULL, NULL);
     SDL_RenderPresent(ctx->renderer);
+    TRACE_END("present_frame");
 }
 
-void menu_screen_logic(AppState *ctx) {
-    if (ctx->appCtx->currentScreen != MENU_SCREEN) {
+// Submit the frame for `rect` (or the whole window when NULL). It goes on screen once the render thread is done
+// with it: at the start of a later iteration, or when the next frame is submitted, whichever comes first.
+// Whole frames are compared with the previous one first; an identical frame is dropped and a changed one only
+// rasterizes and uploads the area that differs.
+void present_frame_rect(AppState *ctx, SDL_Rect const *rect) {
+    // Offscreen (golden image) rendering has no renderer; the pixels are all there is.
+    if (!ctx->renderer) {
+        flush_frame_(ctx);
         return;
     }
-    if (ctx->appCtx->menuScreenCtx->total_items == 0) {
-        ctx->appCtx->menuScreenCtx->total_items = MENU_COUNT;
-        // Fill menu
-        const MenuScreenOption_t items[MENU_COUNT] = {
-            {"Keyboard test", "1.0", "Check keyboard scancodes"},
-            {"File explorer", "0.1", "Read files and directories"},
-            {"Sensors", "1.0", "Read sensor data"},
-            {"About", "1.0", "About this app"}
-        };
-        ctx->appCtx->menuScreenCtx->menu_options[0] = items[0];
-        ctx->appCtx->menuScreenCtx->menu_options[1] = items[1];
-        ctx->appCtx->menuScreenCtx->menu_options[2] = items[2];
-        ctx->appCtx->menuScreenCtx->menu_options[3] = items[3];
-        ctx->appCtx->menuScreenCtx->shouldRepaint = true;
+    if (!rect && !dl_dedup(&ctx->dedup, &ctx->frame, WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        dl_reset(&ctx->frame);
+        return;
+    }
+    present_pending_(ctx);
+    const SDL_Rect damage = ctx->frame.damage;
+    ctx->hud.pixelsTouched += dl_pipeline_submit(&ctx->pipeline, &ctx->frame);
+    ctx->presentRect = rect ? *rect : damage;
+    ctx->presentPending = true;
+}
+
+void present_frame(AppState *ctx) {
+    present_frame_rect(ctx, NULL);
+}
+
+// Account the iteration that started at `start` and refresh the overlay when it's due.
+static void hud_frame_end_(AppState *ctx, Uint64 start) {
+    PerfHud *hud = &ctx->hud;
+    const Uint64 now = SDL_GetTicksNS();
+    hud->workMs[hud->sample] = (float) (now - start) / SDL_NS_PER_MS;
+    hud->sample = (hud->sample + 1) % HUD_SAMPLES;
+    if (hud->lastIterate) {
+        hud->intervalMs = (float) (start - hud->lastIterate) / SDL_NS_PER_MS;
+    }
+    hud->lastIterate = start;
+    hud->pixelsLastFrame = hud->pixelsTouched;
+    hud->pixelsTouched = 0;
+
+    if (hud->visible && now - hud->lastDraw >= HUD_REFRESH_NS) {
+        hud_render_(ctx);
+        const SDL_Rect rect = {HUD_X, HUD_Y, HUD_W, HUD_H};
+        present_frame_rect(ctx, &rect);
     }
+}
+
+// Make whatever screen is active draw itself again on the next iteration, in full.
+void request_repaint(AppState *ctx) {
+    dl_dedup_invalidate(&ctx->dedup);
+    ctx->uiShown = NULL;
+}
+
+/*
+ * Widgets
+ */
+#define UI_TITLE_H    45
+#define UI_WINDOW_X   30
+#define UI_WINDOW_Y   30
+#define UI_WINDOW_W   (WINDOW_WIDTH - 60)
+#define UI_WINDOW_H   (WINDOW_HEIGHT - 60)
+#define UI_LIST_W     (UI_WINDOW_W - 30)
+#define UI_LINES_Y    120
+#define UI_LINE_STEP  (FONT_HEIGHT + 8)
+
+static SDL_Rect ui_bounds_(UiWidget const *w) {
+    if (!w->visible) {
+        return (SDL_Rect) {0, 0, 0, 0};
+    }
+    switch (w->kind) {
+        case UI_WINDOW: return (SDL_Rect) {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT}; // paints the desktop too
+        case UI_LABEL: {
+            const int text_w = get_text_width(w->text);
+            const int x = (w->flags & UI_CENTERED) ? w->rect.x + (w->rect.w - text_w) / 2 : w->rect.x;
+            return (SDL_Rect) {x, w->rect.y, text_w + ((w->flags & UI_BOLD) ? 1 : 0), FONT_HEIGHT};
+        }
+        default: return w->rect;
+    }
+}
+
+static void ui_invalidate_rect_(UiScreen *ui, SDL_Rect const *rect) {
+    SDL_GetRectUnion(&ui->damage, rect, &ui->damage);
+}
+
+// Repaint widget `id` in full on the next ui_render(), e.g. after the data behind a list changed.
+void ui_invalidate(UiScreen *ui, int id) {
+    const SDL_Rect bounds = ui_bounds_(&ui->widgets[id]);
+    ui_invalidate_rect_(ui, &bounds);
+}
+
+int ui_add(UiScreen *ui, UiWidget widget) {
+    SDL_assert(ui->count < UI_MAX_WIDGETS);
+    widget.visible = true;
+    ui->widgets[ui->count] = widget;
+    ui_invalidate(ui, ui->count);
+    return ui->count++;
+}
 
-    if (!ctx->appCtx->menuScreenCtx->shouldRepaint) {
+int ui_add_label(UiScreen *ui, int x, int y, int w, int flags, char const *text, Uint32 color) {
+    UiWidget label = {.kind = UI_LABEL, .rect = {x, y, w, FONT_HEIGHT}, .color = color, .flags = flags};
+    SDL_strlcpy(label.text, text, sizeof(label.text));
+    return ui_add(ui, label);
+}
+
+void ui_set_text(UiScreen *ui, int id, char const *text) {
+    UiWidget *w = &ui->widgets[id];
+    if (SDL_strncmp(w->text, text, sizeof(w->text) - 1) == 0) {
         return;
     }
+    ui_invalidate(ui, id);
+    SDL_strlcpy(w->text, text, sizeof(w->text));
+    ui_invalidate(ui, id);
+}
 
-    int window_x = 30;
-    int window_y = 30;
-    int window_w = WINDOW_WIDTH - 60;
-    int window_h = WINDOW_HEIGHT - 60;
+void ui_set_visible(UiScreen *ui, int id, bool visible) {
+    if (ui->widgets[id].visible == visible) {
+        return;
+    }
+    ui_invalidate(ui, id); // what it covered, if it was showing
+    ui->widgets[id].visible = visible;
+    ui_invalidate(ui, id); // what it will cover, if it is showing now
+}
 
-    draw_rect(ctx, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, CDE_BG_COLOR);
+static SDL_Rect ui_row_rect_(UiWidget const *w, int index) {
+    const SDL_Rect row = {w->rect.x + 3, w->rect.y + 3 + (index - w->offset) * w->rowHeight, w->rect.w - 6, w->rowHeight};
+    SDL_Rect visible = {0, 0, 0, 0};
+    SDL_GetRectIntersection(&row, &w->rect, &visible);
+    return visible;
+}
 
-    draw_rect(ctx, window_x, window_y, window_w, window_h, CDE_PANEL_COLOR);
-    draw_3d_border(ctx, window_x, window_y, window_w, window_h, 0);
+// When only the selection moves within the page, just the two rows involved are repainted.
+void ui_set_list(UiScreen *ui, int id, int count, int selected, int offset) {
+    UiWidget *w = &ui->widgets[id];
+    if (w->count != count || w->offset != offset) {
+        w->count = count;
+        w->selected = selected;
+        w->offset = offset;
+        ui_invalidate(ui, id);
+    } else if (w->selected != selected) {
+        SDL_Rect row = ui_row_rect_(w, w->selected);
+        ui_invalidate_rect_(ui, &row);
+        row = ui_row_rect_(w, selected);
+        ui_invalidate_rect_(ui, &row);
+        w->selected = selected;
+    }
+}
 
-    int title_h = 45;
-    draw_rect(ctx, window_x + 3, window_y + 3, window_w - 6, title_h, CDE_TITLE_BG);
-    draw_text_bold(ctx, window_x + 15, window_y + 11, "Random App - Menu", CDE_SELECTED_TEXT);
+// Hidden while everything fits on one page.
+void ui_set_scroll(UiScreen *ui, int id, int total, int per_page, int offset) {
+    UiWidget *w = &ui->widgets[id];
+    if (w->count != total || w->perPage != per_page || w->offset != offset) {
+        w->count = total;
+        w->perPage = per_page;
+        w->offset = offset;
+        ui_invalidate(ui, id);
+    }
+    ui_set_visible(ui, id, total > per_page);
+}
 
-    char count_text[64];
-    SDL_snprintf(count_text, sizeof(count_text), "Menu Options Available: %d", ctx->appCtx->menuScreenCtx->total_items);
-    draw_text(ctx, window_x + 15, window_y + title_h + 20, count_text, CDE_TEXT_COLOR);
+void ui_set_progress(UiScreen *ui, int id, int value, int max) {
+    UiWidget *w = &ui->widgets[id];
+    if (w->selected != value || w->count != max) {
+        w->selected = value;
+        w->count = max;
+        ui_invalidate(ui, id);
+    }
+}
 
-    int list_y = window_y + title_h + 55;
-    int list_h = window_h - title_h - 110;
-    int item_height = 80;
+static void ui_draw_list_(AppState *ctx, UiWidget const *w) {
+    draw_rect(ctx, w->rect.x, w->rect.y, w->rect.w, w->rect.h, 0xFFFFFF);
+    draw_3d_border(ctx, w->rect.x, w->rect.y, w->rect.w, w->rect.h, 1);
 
-    draw_rect(ctx, window_x + 15, list_y, window_w - 30, list_h, 0xFFFFFF);
-    draw_3d_border(ctx, window_x + 15, list_y, window_w - 30, list_h, 1);
+    const int visible_end = SDL_min(w->offset + w->perPage, w->count);
+    for (int i = w->offset; i < visible_end; i++) {
+        const int item_x = w->rect.x + 3;
+        const int item_y = w->rect.y + 3 + (i - w->offset) * w->rowHeight;
+        const int item_w = w->rect.w - 6;
 
-    ctx->appCtx->menuScreenCtx->items_per_page = (list_h - 6) / item_height;
-    int visible_start = ctx->appCtx->menuScreenCtx->scroll_offset;
-    int visible_end = visible_start + ctx->appCtx->menuScreenCtx->items_per_page;
-    if (visible_end > ctx->appCtx->menuScreenCtx->total_items)
-        visible_end = ctx->appCtx->menuScreenCtx->total_items;
+        if (i == w->selected) {
+            draw_rect(ctx, item_x, item_y, item_w, w->rowHeight - 2, CDE_SELECTED_BG);
+        }
+        const Uint32 text_color = (i == w->selected) ? CDE_SELECTED_TEXT : CDE_TEXT_COLOR;
 
-    for (int i = visible_start; i < visible_end; i++) {
-        int item_y = list_y + 3 + (i - visible_start) * item_height;
-        int item_x = window_x + 18;
-        int item_w = window_w - 36;
+        char lines[3][UI_TEXT_MAX];
+        w->rowText(w->userdata, i, lines);
+        draw_text_bold(ctx, item_x + 8, item_y + 6, lines[0], text_color);
+        draw_text(ctx, item_x + 8, item_y + 30, lines[1], text_color);
+        draw_text(ctx, item_x + 8, item_y + 54, lines[2], text_color);
 
-        if (i == ctx->appCtx->menuScreenCtx->selected_item) {
-            draw_rect(ctx, item_x, item_y, item_w, item_height - 2, CDE_SELECTED_BG);
+        if (i < visible_end - 1) {
+            draw_rect(ctx, item_x, item_y + w->rowHeight - 2, item_w, 1, CDE_BORDER_DARK);
         }
+    }
+}
+
+static void ui_draw_scrollbar_(AppState *ctx, UiWidget const *w) {
+    draw_rect(ctx, w->rect.x, w->rect.y, w->rect.w, w->rect.h, CDE_BUTTON_COLOR);
+    draw_3d_border(ctx, w->rect.x, w->rect.y, w->rect.w, w->rect.h, 1);
+
+    int thumb_h = (w->rect.h * w->perPage) / w->count;
+    if (thumb_h < 30)
+        thumb_h = 30; // Minimum thumb size
+    const int thumb_y = w->rect.y + ((w->rect.h - thumb_h) * w->offset) / (w->count - w->perPage);
 
-        Uint32 text_color = (i == ctx->appCtx->menuScreenCtx->selected_item) ? CDE_SELECTED_TEXT : CDE_TEXT_COLOR;
-
-        draw_text_bold(ctx, item_x + 8, item_y + 6, ctx->appCtx->menuScreenCtx->menu_options[i].name, text_color);
-
-        char version_text[64];
-        SDL_snprintf(version_text, sizeof(version_text), "Version: %s",
-                 ctx->appCtx->menuScreenCtx->menu_options[i].version);
-        draw_text(ctx, item_x + 8, item_y + 30, version_text, text_color);
-
-        char desc[60] = {0};
-        int max_desc_chars = (item_w - 16) / FONT_WIDTH;
-        if (max_desc_chars > 59)
-            max_desc_chars = 59;
-        if (ctx->appCtx->menuScreenCtx->menu_options[i].description) {
-            strncpy(desc, ctx->appCtx->menuScreenCtx->menu_options[i].description, max_desc_chars);
-            desc[max_desc_chars] = '\0';
-            if (strlen(ctx->appCtx->menuScreenCtx->menu_options[i].description) > max_desc_chars) {
-                desc[max_desc_chars - 3] = '.';
-                desc[max_desc_chars - 2] = '.';
-                desc[max_desc_chars - 1] = '.';
+    draw_rect(ctx, w->rect.x + 3, thumb_y, w->rect.w - 6, thumb_h, CDE_PANEL_COLOR);
+    draw_3d_border(ctx, w->rect.x + 3, thumb_y, w->rect.w - 6, thumb_h, 0);
+}
+
+static void ui_draw_(AppState *ctx, UiWidget const *w) {
+    switch (w->kind) {
+        case UI_WINDOW:
+            draw_rect(ctx, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, CDE_BG_COLOR);
+            draw_rect(ctx, w->rect.x, w->rect.y, w->rect.w, w->rect.h, CDE_PANEL_COLOR);
+            draw_3d_border(ctx, w->rect.x, w->rect.y, w->rect.w, w->rect.h, 0);
+            draw_rect(ctx, w->rect.x + 3, w->rect.y + 3, w->rect.w - 6, UI_TITLE_H, CDE_TITLE_BG);
+            draw_text_bold(ctx, w->rect.x + 15, w->rect.y + 11, w->text, CDE_SELECTED_TEXT);
+            break;
+        case UI_LABEL: {
+            const SDL_Rect bounds = ui_bounds_(w);
+            if (w->flags & UI_BOLD) {
+                draw_text_bold(ctx, bounds.x, bounds.y, w->text, w->color);
+            } else {
+                draw_text(ctx, bounds.x, bounds.y, w->text, w->color);
             }
+            break;
+        }
+        case UI_LIST: ui_draw_list_(ctx, w); break;
+        case UI_SCROLLBAR: ui_draw_scrollbar_(ctx, w); break;
+        case UI_PROGRESS: {
+            const int inner_w = w->rect.w - 6;
+            const int fill_w = w->count > 0 ? inner_w * SDL_clamp(w->selected, 0, w->count) / w->count : 0;
+            draw_rect(ctx, w->rect.x, w->rect.y, w->rect.w, w->rect.h, CDE_PROGRESS_BG);
+            draw_3d_border(ctx, w->rect.x, w->rect.y, w->rect.w, w->rect.h, 1);
+            draw_rect(ctx, w->rect.x + 3, w->rect.y + 3, fill_w, w->rect.h - 6, CDE_PROGRESS_FG);
+            break;
         }
-        draw_text(ctx, item_x + 8, item_y + 54, desc, text_color);
+    }
+}
 
-        if (i < visible_end - 1) {
-            draw_rect(ctx, item_x, item_y + item_height - 2, item_w, 1, CDE_BORDER_DARK);
+// Repaint whatever changed since the last call, and present only that.
+void ui_render(AppState *ctx, UiScreen *ui) {
+    const SDL_Rect screen = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    if (ctx->uiShown != ui) {
+        // Something else is in the pixels
+        ui->damage = screen;
+        ctx->uiShown = ui;
+    }
+    SDL_Rect damage;
+    if (!SDL_GetRectIntersection(&ui->damage, &screen, &damage)) {
+        return;
+    }
+    ui->damage = (SDL_Rect) {0, 0, 0, 0};
+
+    // Whole widgets are recorded; rasterization is clipped to the damage.
+    for (int i = 0; i < ui->count; i++) {
+        const SDL_Rect bounds = ui_bounds_(&ui->widgets[i]);
+        if (SDL_HasRectIntersection(&bounds, &damage)) {
+            ui_draw_(ctx, &ui->widgets[i]);
         }
     }
+    if (SDL_RectsEqual(&damage, &screen)) {
+        present_frame(ctx);
+    } else {
+        ctx->frame.damage = damage;
+        present_frame_rect(ctx, &damage);
+        // The pixels no longer match the last whole frame the dedup check saw
+        dl_dedup_invalidate(&ctx->dedup);
+    }
+}
 
-    if (ctx->appCtx->menuScreenCtx->total_items > ctx->appCtx->menuScreenCtx->items_per_page) {
-        int scrollbar_x = window_x + window_w - 35;
-        int scrollbar_y = list_y + 3;
-        int scrollbar_h = list_h - 6;
+static int ui_add_window_(UiScreen *ui, char const *title) {
+    UiWidget window = {.kind = UI_WINDOW, .rect = {UI_WINDOW_X, UI_WINDOW_Y, UI_WINDOW_W, UI_WINDOW_H}};
+    SDL_strlcpy(window.text, title, sizeof(window.text));
+    return ui_add(ui, window);
+}
 
-        draw_rect(ctx, scrollbar_x, scrollbar_y, 20, scrollbar_h, CDE_BUTTON_COLOR);
-        draw_3d_border(ctx, scrollbar_x, scrollbar_y, 20, scrollbar_h, 1);
+// Centered lines of text down the window, one label each. Returns the id of the first.
+static int ui_add_lines_(UiScreen *ui, char const *const *lines, int count) {
+    const int first = ui->count;
+    for (int i = 0; i < count; i++) {
+        ui_add_label(ui, UI_WINDOW_X, UI_LINES_Y + i * UI_LINE_STEP, UI_WINDOW_W, UI_CENTERED, lines[i], CDE_TEXT_COLOR);
+    }
+    return first;
+}
 
-        int thumb_h = (scrollbar_h * ctx->appCtx->menuScreenCtx->items_per_page) / ctx->appCtx->menuScreenCtx->
-                      total_items;
-        if (thumb_h < 30)
-            thumb_h = 30; // Minimum thumb size
-        int thumb_y = scrollbar_y;
-        if (ctx->appCtx->menuScreenCtx->total_items > ctx->appCtx->menuScreenCtx->items_per_page) {
-            thumb_y += ((scrollbar_h - thumb_h) * ctx->appCtx->menuScreenCtx->scroll_offset) / (
-                ctx->appCtx->menuScreenCtx->total_items - ctx->appCtx->menuScreenCtx->items_per_page);
-        }
+// The window/count/list/scrollbar/footer layout shared by the menu and the file explorer.
+enum { LIST_UI_WINDOW, LIST_UI_COUNT, LIST_UI_LIST, LIST_UI_SCROLLBAR, LIST_UI_FOOTER };
+
+static void ui_add_list_screen_(UiScreen *ui, char const *title, UiRowFn row_text, void *userdata) {
+    const int list_y = UI_WINDOW_Y + UI_TITLE_H + 55;
+    const int list_h = UI_WINDOW_H - UI_TITLE_H - 110;
+    const int row_height = 80;
+
+    ui_add_window_(ui, title);
+    ui_add_label(ui, UI_WINDOW_X + 15, UI_WINDOW_Y + UI_TITLE_H + 20, 0, 0, "", CDE_TEXT_COLOR);
+    ui_add(ui, (UiWidget) {
+        .kind = UI_LIST,
+        .rect = {UI_WINDOW_X + 15, list_y, UI_LIST_W, list_h},
+        .perPage = (list_h - 6) / row_height,
+        .rowHeight = row_height,
+        .rowText = row_text,
+        .userdata = userdata,
+    });
+    ui_add(ui, (UiWidget) {.kind = UI_SCROLLBAR, .rect = {UI_WINDOW_X + UI_WINDOW_W - 35, list_y + 3, 20, list_h - 6}});
+    ui_add_label(ui, UI_WINDOW_X + 15, UI_WINDOW_Y + UI_WINDOW_H - 35, 0, 0, "", CDE_TEXT_COLOR);
+}
 
-        draw_rect(ctx, scrollbar_x + 3, thumb_y, 14, thumb_h, CDE_PANEL_COLOR);
-        draw_3d_border(ctx, scrollbar_x + 3, thumb_y, 14, thumb_h, 0);
+void welcome_screen_logic(AppState *ctx) {
+    if (ctx->appCtx->currentScreen != WELCOME_SCREEN) {
+        return;
     }
+    WelcomeScreenContext *welcome = ctx->appCtx->welcomeScreenCtx;
+    enum { WELCOME_UI_WINDOW, WELCOME_UI_PROMPT };
 
-    draw_text(
-        ctx,
-        window_x + 15,
-        window_y + window_h - 35,
-        "UP/DOWN to navigate, SPACE to open, ESC to exit",
-        CDE_TEXT_COLOR
-    );
+    //First time here?
+    if (welcome->ui.count == 0) {
+        ui_add_window_(&welcome->ui, "Random App - Welcome");
+        ui_add_label(&welcome->ui, UI_WINDOW_X, UI_WINDOW_Y + UI_WINDOW_H / 2, UI_WINDOW_W, UI_CENTERED,
+                     "Press any key to continue...", CDE_TEXT_COLOR);
+        welcome->lastChange = replay_ticks();
+        welcome->showWelcomeScreenDesc = true;
+    }
 
-    // Render everything
-    SDL_RenderClear(ctx->renderer);
-    SDL_UpdateTexture(ctx->framebuffer, NULL, ctx->pixels, WINDOW_WIDTH * sizeof(Uint16));
-    SDL_RenderTexture(ctx->renderer, ctx->framebuffer, NULL, NULL);
-    SDL_RenderPresent(ctx->renderer);
+    const int blink_interval = 500; // milliseconds
+    const Uint64 now = replay_ticks();
+    if (now - welcome->lastChange >= blink_interval) {
+        welcome->showWelcomeScreenDesc = !welcome->showWelcomeScreenDesc;
+        welcome->lastChange = now;
+    }
+    ui_set_visible(&welcome->ui, WELCOME_UI_PROMPT, welcome->showWelcomeScreenDesc);
+
+    ui_render(ctx, &welcome->ui);
+}
+
+static void menu_row_(void *userdata, int index, char lines[3][UI_TEXT_MAX]) {
+    MenuScreenOption_t const *option = &((MenuScreenContext const *) userdata)->menu_options[index];
+    SDL_strlcpy(lines[0], option->name, UI_TEXT_MAX);
+    SDL_snprintf(lines[1], UI_TEXT_MAX, "Version: %s", option->version);
+
+    char const *desc = option->description ? option->description : "";
+    const int max_desc_chars = SDL_min((UI_LIST_W - 6 - 16) / FONT_WIDTH, 59);
+    if ((int) SDL_strlen(desc) > max_desc_chars) {
+        SDL_snprintf(lines[2], UI_TEXT_MAX, "%.*s...", max_desc_chars - 3, desc);
+    } else {
+        SDL_strlcpy(lines[2], desc, UI_TEXT_MAX);
+    }
+}
+
+void menu_screen_logic(AppState *ctx) {
+    if (ctx->appCtx->currentScreen != MENU_SCREEN) {
+        return;
+    }
+    MenuScreenContext *menu = ctx->appCtx->menuScreenCtx;
+    if (menu->total_items == 0) {
+        menu->total_items = MENU_COUNT;
+        // Fill menu
+        const MenuScreenOption_t items[MENU_COUNT] = {
+            {"Keyboard test", "1.0", "Check keyboard scancodes"},
+            {"File explorer", "0.1", "Read files and directories"},
+            {"Sensors", "1.0", "Read sensor data"},
+            {"About", "1.0", "About this app"}
+        };
+        menu->menu_options[0] = items[0];
+        menu->menu_options[1] = items[1];
+        menu->menu_options[2] = items[2];
+        menu->menu_options[3] = items[3];
+    }
+    if (menu->ui.count == 0) {
+        ui_add_list_screen_(&menu->ui, "Random App - Menu", menu_row_, menu);
+        ui_set_text(&menu->ui, LIST_UI_FOOTER, "UP/DOWN to navigate, SPACE to open, ESC to exit");
+        menu->items_per_page = menu->ui.widgets[LIST_UI_LIST].perPage;
+    }
+
+    char count_text[64];
+    SDL_snprintf(count_text, sizeof(count_text), "Menu Options Available: %d", menu->total_items);
+    ui_set_text(&menu->ui, LIST_UI_COUNT, count_text);
+    ui_set_list(&menu->ui, LIST_UI_LIST, menu->total_items, menu->selected_item, menu->scroll_offset);
+    ui_set_scroll(&menu->ui, LIST_UI_SCROLLBAR, menu->total_items, menu->items_per_page, menu->scroll_offset);
+
+    ui_render(ctx, &menu->ui);
 }
 
 void files_screen_handle_key(AppState *as, const SDL_Scancode key_code) {
@@ -427,7 +821,6 @@ void files_screen_handle_key(AppState *as, const SDL_Scancode key_code) {
         return;
     }
 
-    as->appCtx->filesScreenCtx->shouldRepaint = true;
     FilesScreenContext *ctx = as->appCtx->filesScreenCtx;
     switch (key_code) {
         case SDL_SCANCODE_UP:
@@ -453,18 +846,25 @@ void files_screen_handle_key(AppState *as, const SDL_Scancode key_code) {
         case SDL_SCANCODE_RETURN:
         case SDL_SCANCODE_SPACE:
             SDL_Log("files_screen_handle_key; (space/return) selected_item: %d\n", ctx->selected_item);
+            if (ctx->total_items == 0) {
+                break; // listing not loaded (or empty)
+            }
             // Check if the selected item is a directory; If so, change currentDirectory.
             char fullpath[4096];
             SDL_snprintf(fullpath, sizeof(fullpath), "%s/%s", ctx->currentDirectory, ctx->entries[ctx->selected_item]);
             SDL_PathInfo info;
+            TRACE_BEGIN("SDL_GetPathInfo");
             if (!SDL_GetPathInfo(fullpath, &info)) {
                 SDL_Log("  %s  [ERROR: %s]", ctx->entries[ctx->selected_item], SDL_GetError());
             }
+            TRACE_END("SDL_GetPathInfo");
             if (info.type == SDL_PATHTYPE_DIRECTORY) {
                 SDL_snprintf(ctx->currentDirectory, sizeof(ctx->currentDirectory), "%s", fullpath);
                 ctx->total_items = 0;
                 ctx->selected_item = 0;
-                //SDL_free(ctx->entries);
+                ctx->scroll_offset = 0;
+                SDL_free(ctx->entries);
+                ctx->entries = NULL;
             }
             break;
         default: break;
@@ -475,7 +875,6 @@ void menu_screen_handle_key(AppState *as, const SDL_Scancode key_code) {
     if (as->appCtx->currentScreen != MENU_SCREEN) {
         return;
     }
-    as->appCtx->menuScreenCtx->shouldRepaint = true;
     MenuScreenContext *ctx = as->appCtx->menuScreenCtx;
     switch (key_code) {
         case SDL_SCANCODE_UP:
@@ -524,18 +923,29 @@ void menu_screen_handle_key(AppState *as, const SDL_Scancode key_code) {
     }
 }
 
-void files_screen_logic(AppState *ctx) {
-    if (ctx->appCtx->currentScreen != FILES_SCREEN) {
-        return;
+
+static void files_row_(void *userdata, int index, char lines[3][UI_TEXT_MAX]) {
+    FilesScreenContext const *files = (FilesScreenContext const *) userdata;
+    char fullpath[4096];
+    SDL_snprintf(fullpath, sizeof(fullpath), "%s/%s", files->currentDirectory, files->entries[index]);
+    SDL_PathInfo info;
+    SDL_zero(info);
+    TRACE_BEGIN("SDL_GetPathInfo");
+    if (!SDL_GetPathInfo(fullpath, &info)) {
+        SDL_Log("  %s  [ERROR: %s]", files->entries[index], SDL_GetError());
     }
+    TRACE_END("SDL_GetPathInfo");
 
-    // Don't render screen if nothing changed.
-    bool shouldRender = false;
+    SDL_strlcpy(lines[0], files->entries[index], UI_TEXT_MAX);
+    SDL_snprintf(lines[1], UI_TEXT_MAX, "Filetype: %s", pathtype_to_str(info.type));
+    SDL_snprintf(lines[2], UI_TEXT_MAX, "Size: %" SDL_PRIs64, (Sint64) info.size);
+}
 
-    if (ctx->appCtx->keyboardScreenCtx->lastChange == 0) {
-        ctx->appCtx->keyboardScreenCtx->lastChange = SDL_GetTicks();
-        ctx->appCtx->keyboardScreenCtx->shouldRepaint = true;
+void files_screen_logic(AppState *ctx) {
+    if (ctx->appCtx->currentScreen != FILES_SCREEN) {
+        return;
     }
+    FilesScreenContext *files = ctx->appCtx->filesScreenCtx;
 
 #ifdef WHY_BADGE
     char const *rootFolders[] = {
@@ -552,23 +962,44 @@ void files_screen_logic(AppState *ctx) {
     };
 # endif
 
-    if (ctx->appCtx->filesScreenCtx->total_items == 0) {
-        if (strlen(ctx->appCtx->filesScreenCtx->currentDirectory) == 0) {
+    /*
+     * Root folders
+     * SD0
+     * FLASH0
+     * APPS
+     * STORAGE
+     *
+     * Apps should be in:
+     * APPS:[BADGEVMS.APPS]
+     */
+
+    if (files->ui.count == 0) {
+        ui_add_list_screen_(&files->ui, "Random App - Files", files_row_, files);
+        files->items_per_page = files->ui.widgets[LIST_UI_LIST].perPage;
+    }
+
+    if (files->total_items == 0) {
+        if (strlen(files->currentDirectory) == 0) {
             // Initialize to first root folder
-            SDL_snprintf(ctx->appCtx->filesScreenCtx->currentDirectory, sizeof(ctx->appCtx->filesScreenCtx->currentDirectory), "%s", rootFolders[0]);
-            SDL_Log("setting initial directory to '%s'\n", ctx->appCtx->filesScreenCtx->currentDirectory);
+            SDL_snprintf(files->currentDirectory, sizeof(files->currentDirectory), "%s", rootFolders[0]);
+            SDL_Log("setting initial directory to '%s'\n", files->currentDirectory);
         }
         int count = 0;
+        TRACE_BEGIN("SDL_GlobDirectory");
+        // Loading a listing is the one place this screen is allowed to allocate
+        ALLOC_ALLOW_BEGIN();
         char **entries = SDL_GlobDirectory(
-            ctx->appCtx->filesScreenCtx->currentDirectory,
+            files->currentDirectory,
             "*",//NULL,
             0,
             &count
         );
+        ALLOC_ALLOW_END();
+        TRACE_END("SDL_GlobDirectory");
         if (!entries) {
             SDL_Log(
                 "SDL_GlobDirectory error for '%s': %s",
-                ctx->appCtx->filesScreenCtx->currentDirectory,
+                files->currentDirectory,
                 SDL_GetError()
             );
             return; //TODO: foutmelding op scherm tonen
@@ -576,343 +1007,438 @@ void files_screen_logic(AppState *ctx) {
 
         SDL_Log(
             "Listing '%s' (%d items):",
-            ctx->appCtx->filesScreenCtx->currentDirectory,
+            files->currentDirectory,
             count
         );
 
-        ctx->appCtx->filesScreenCtx->total_items = count;
-        ctx->appCtx->filesScreenCtx->entries = entries;
-        ctx->appCtx->filesScreenCtx->shouldRepaint = true;
+        SDL_free(files->entries);
+        files->total_items = count;
+        files->entries = entries;
+        // Same count and position as the old listing still means different rows
+        ui_invalidate(&files->ui, LIST_UI_LIST);
     }
 
-    shouldRender = ctx->appCtx->filesScreenCtx->shouldRepaint;
+    char count_text[64];
+    SDL_snprintf(count_text, sizeof(count_text), "Entries: %d", files->total_items);
+    ui_set_text(&files->ui, LIST_UI_COUNT, count_text);
+    ui_set_list(&files->ui, LIST_UI_LIST, files->total_items, files->selected_item, files->scroll_offset);
+    ui_set_scroll(&files->ui, LIST_UI_SCROLLBAR, files->total_items, files->items_per_page, files->scroll_offset);
+    ui_set_text(&files->ui, LIST_UI_FOOTER, (char const *) files->currentDirectory);
 
-    if (!shouldRender) {
+    ui_render(ctx, &files->ui);
+}
+
+void keyboard_screen_logic(AppState *ctx) {
+    if (ctx->appCtx->currentScreen != KEYBOARD_SCREEN) {
         return;
     }
+    KeyboardScreenContext *keyboard = ctx->appCtx->keyboardScreenCtx;
+    enum { KEYBOARD_UI_LINES = 1, KEYBOARD_UI_SCANCODE = KEYBOARD_UI_LINES + 4 };
 
-    /*
-     * Root folders
-     * SD0
-     * FLASH0
-     * APPS
-     * STORAGE
-     *
-     * Apps should be in:
-     * APPS:[BADGEVMS.APPS]
-     */
-
-    const int window_x = 30;
-    const int window_y = 30;
-    const int window_w = WINDOW_WIDTH - 60;
-    const int window_h = WINDOW_HEIGHT - 60;
+    // First time here?
+    if (keyboard->ui.count == 0) {
+        char const *lines[] = {
+            "Keyboard test",
+            "Press any key, to see its scancode.",
+            "",
+            "Scan code of latest key pressed will be shown below:",
+            "",
+            "",
+            "Press ESC key to return to menu.",
+            "(Press ESC to exit the app)",
+        };
+        ui_add_window_(&keyboard->ui, "Random App - Keyboard");
+        ui_add_lines_(&keyboard->ui, lines, SDL_arraysize(lines));
+    }
 
-    draw_rect(ctx, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, CDE_BG_COLOR);
+    char latestScanCodeAsString[128];
+    SDL_snprintf(latestScanCodeAsString, sizeof(latestScanCodeAsString), "0x%02X", keyboard->latestScancode);
+    ui_set_text(&keyboard->ui, KEYBOARD_UI_SCANCODE, latestScanCodeAsString);
 
-    draw_rect(ctx, window_x, window_y, window_w, window_h, CDE_PANEL_COLOR);
-    draw_3d_border(ctx, window_x, window_y, window_w, window_h, 0);
+    ui_render(ctx, &keyboard->ui);
+}
 
-    const int title_h = 45;
-    draw_rect(ctx, window_x + 3, window_y + 3, window_w - 6, title_h, CDE_TITLE_BG);
-    draw_text_bold(ctx, window_x + 15, window_y + 11, "Random App - Files", CDE_SELECTED_TEXT);
+void about_screen_logic(AppState *ctx) {
+    if (ctx->appCtx->currentScreen != ABOUT_SCREEN) {
+        return;
+    }
+    AboutScreenContext *about = ctx->appCtx->aboutScreenCtx;
+
+    if (about->ui.count == 0) {
+        char const *lines[] = {
+            "RandomApp is a simple demo application",
+            "showcasing SDL3 features on the WHY Badge.",
+            "",
+            "Created by FrankkieNL, 2025.",
+            "Version:",
+            APP_VERSION,
+            "",
+            "Visit https://badge.why2025.org for more info.",
+            "",
+            "Press any key to return.",
+        };
+        ui_add_window_(&about->ui, "Random App - About");
+        ui_add_lines_(&about->ui, lines, SDL_arraysize(lines));
+    }
 
-    char count_text[64];
-    SDL_snprintf(count_text, sizeof(count_text), "Entries: %d", ctx->appCtx->filesScreenCtx->total_items);
-    draw_text(ctx, window_x + 15, window_y + title_h + 20, count_text, CDE_TEXT_COLOR);
+    ui_render(ctx, &about->ui);
+}
 
-    int list_y = window_y + title_h + 55;
-    int list_h = window_h - title_h - 110;
-    int item_height = 80;
+void sensors_screen_logic(AppState *ctx) {
+    if (ctx->appCtx->currentScreen != SENSORS_SCREEN) {
+        return;
+    }
+    SensorsScreenContext *sensors = ctx->appCtx->sensorsScreenCtx;
 
-    draw_rect(ctx, window_x + 15, list_y, window_w - 30, list_h, 0xFFFFFF);
-    draw_3d_border(ctx, window_x + 15, list_y, window_w - 30, list_h, 1);
+#ifdef WHY_BADGE
+    enum {
+        SENSORS_UI_LINES = 1,
+        SENSORS_UI_ORIENTATION = SENSORS_UI_LINES + 3,
+        SENSORS_UI_DEGREES,
+        SENSORS_UI_TEMPERATURE = SENSORS_UI_LINES + 7,
+        SENSORS_UI_HUMIDITY,
+        SENSORS_UI_PRESSURE,
+        SENSORS_UI_GAS,
+        SENSORS_UI_HUMIDITY_BAR = SENSORS_UI_LINES + 13,
+    };
+    if (sensors->ui.count == 0) {
+        char const *lines[] = {
+            "Sensors screen",
+            "",
+            "BMI 270 - Orientation sensor",
+            "",
+            "",
+            "",
+            "BME 690 - Gas sensor",
+            "",
+            "",
+            "",
+            "",
+            "",
+            "Press any key to return.",
+        };
+        ui_add_window_(&sensors->ui, "Random App - Sensors");
+        ui_add_lines_(&sensors->ui, lines, SDL_arraysize(lines));
+        ui_add(&sensors->ui, (UiWidget) {
+            .kind = UI_PROGRESS,
+            .rect = {UI_WINDOW_X + 60, UI_LINES_Y + SDL_arraysize(lines) * UI_LINE_STEP, UI_WINDOW_W - 120, 24},
+            .count = 100,
+        });
+    }
 
-    ctx->appCtx->filesScreenCtx->items_per_page = (list_h - 6) / item_height;
-    int visible_start = ctx->appCtx->filesScreenCtx->scroll_offset;
-    int visible_end = visible_start + ctx->appCtx->filesScreenCtx->items_per_page;
-    if (visible_end > ctx->appCtx->filesScreenCtx->total_items)
-        visible_end = ctx->appCtx->filesScreenCtx->total_items;
+    // Only the readings that changed since the last frame get repainted
+    char sensor[128];
+    if (sensors->orientationSensor != NULL) {
+        orientation_device_t *orientation_device = sensors->orientationSensor;
+        SDL_snprintf(sensor, sizeof(sensor), "orientation: %d", orientation_device->_get_orientation(orientation_device));
+        ui_set_text(&sensors->ui, SENSORS_UI_ORIENTATION, sensor);
+        SDL_snprintf(sensor, sizeof(sensor), "orientation degress: %d",
+                 orientation_device->_get_orientation_degrees(orientation_device));
+        ui_set_text(&sensors->ui, SENSORS_UI_DEGREES, sensor);
+    }
+    if (sensors->gasSensor != NULL) {
+        gas_device_t *gas = sensors->gasSensor;
+        const float humidity = (float) gas->_get_humidity(gas);
+        SDL_snprintf(sensor, sizeof(sensor), "Temperature in Celsius: %.2f \n", gas->_get_temperature(gas));
+        ui_set_text(&sensors->ui, SENSORS_UI_TEMPERATURE, sensor);
+        SDL_snprintf(sensor, sizeof(sensor), "Humidity in Rel. Percentage: %.2f \n", humidity);
+        ui_set_text(&sensors->ui, SENSORS_UI_HUMIDITY, sensor);
+        SDL_snprintf(sensor, sizeof(sensor), "Pressure in Pascal: %.2f \n", gas->_get_pressure(gas));
+        ui_set_text(&sensors->ui, SENSORS_UI_PRESSURE, sensor);
+        SDL_snprintf(sensor, sizeof(sensor), "Gas Resistance in Ohm: %.2f \n", gas->_get_gas_resistance(gas));
+        ui_set_text(&sensors->ui, SENSORS_UI_GAS, sensor);
+        ui_set_progress(&sensors->ui, SENSORS_UI_HUMIDITY_BAR, (int) humidity, 100);
+    }
+#else
+    if (sensors->ui.count == 0) {
+        char const *lines[] = {
+            "Sensors screen",
+            "No sensors found, ",
+            "as this is not a WHY Badge build of this app",
+            "Press any key to return.",
+        };
+        ui_add_window_(&sensors->ui, "Random App - Sensors");
+        ui_add_lines_(&sensors->ui, lines, SDL_arraysize(lines));
+    }
+#endif
 
-    for (int i = visible_start; i < visible_end; i++) {
-        int item_y = list_y + 3 + (i - visible_start) * item_height;
-        int item_x = window_x + 18;
-        int item_w = window_w - 36;
+    ui_render(ctx, &sensors->ui);
+}
 
-        if (i == ctx->appCtx->filesScreenCtx->selected_item) {
-            draw_rect(ctx, item_x, item_y, item_w, item_height - 2, CDE_SELECTED_BG);
-        }
+/*
+ * Golden image check
+ *
+ * `randomapp --golden <dir>` renders the screens and a set of primitive edge cases into the offscreen
+ * RGB565 buffer and compares the FNV-1a hash of each result against <dir>/golden.txt, one "<name> <hash>" line
+ * per case. Add `--record` to rewrite golden.txt from the current build; that also leaves every image as
+ * <dir>/<name>.bmp, which is not checked in. A mismatch writes <dir>/<name>.actual.bmp and, next to a <name>.bmp
+ * recorded from a known-good build, <dir>/<name>.diff.bmp with the differing pixels in red.
+ * The files screen depends on the filesystem and is left out; the sensors screen is only stable on desktop.
+ */
+static void golden_reset_(AppState *ctx, int screen) {
+    SDL_zerop(ctx->appCtx->welcomeScreenCtx);
+    SDL_zerop(ctx->appCtx->menuScreenCtx);
+    SDL_zerop(ctx->appCtx->keyboardScreenCtx);
+    SDL_zerop(ctx->appCtx->sensorsScreenCtx);
+    SDL_zerop(ctx->appCtx->aboutScreenCtx);
+    ctx->appCtx->currentScreen = screen;
+    ctx->uiShown = NULL;
+    SDL_memset(ctx->pixels, 0, WINDOW_WIDTH * WINDOW_HEIGHT * sizeof(px_t));
+}
 
-        Uint32 text_color = (i == ctx->appCtx->filesScreenCtx->selected_item) ? CDE_SELECTED_TEXT : CDE_TEXT_COLOR;
+static void golden_welcome_(AppState *ctx) {
+    golden_reset_(ctx, WELCOME_SCREEN);
+    welcome_screen_logic(ctx);
+}
 
-        // Draw Filename
-        draw_text_bold(ctx, item_x + 8, item_y + 6, ctx->appCtx->filesScreenCtx->entries[i], text_color);
+static void golden_menu_(AppState *ctx) {
+    golden_reset_(ctx, MENU_SCREEN);
+    menu_screen_logic(ctx);
+}
 
-        // Draw Filetype
-        char fullpath[4096];
-        SDL_snprintf(fullpath, sizeof(fullpath), "%s/%s", ctx->appCtx->filesScreenCtx->currentDirectory, ctx->appCtx->filesScreenCtx->entries[i]);
-        SDL_PathInfo info;
-        if (!SDL_GetPathInfo(fullpath, &info)) {
-            SDL_Log("  %s  [ERROR: %s]", ctx->appCtx->filesScreenCtx->entries[i], SDL_GetError());
-        }
-        char filetype_text[64];
-        SDL_snprintf(filetype_text, sizeof(filetype_text), "Filetype: %s",
-                 pathtype_to_str(info.type));
-        draw_text(ctx, item_x + 8, item_y + 30, filetype_text, text_color);
+static void golden_menu_selected_(AppState *ctx) {
+    golden_reset_(ctx, MENU_SCREEN);
+    ctx->appCtx->menuScreenCtx->selected_item = MENU_ABOUT;
+    menu_screen_logic(ctx);
+}
 
-        // Draw description??
-        char desc[60];
-        SDL_snprintf(desc, sizeof(desc), "Size: %i", info.size);
-        draw_text(ctx, item_x + 8, item_y + 54, desc, text_color);
+static void golden_keyboard_(AppState *ctx) {
+    golden_reset_(ctx, KEYBOARD_SCREEN);
+    ctx->appCtx->keyboardScreenCtx->latestScancode = SDL_SCANCODE_A;
+    keyboard_screen_logic(ctx);
+}
 
-        if (i < visible_end - 1) {
-            draw_rect(ctx, item_x, item_y + item_height - 2, item_w, 1, CDE_BORDER_DARK);
-        }
-    }
+static void golden_sensors_(AppState *ctx) {
+    golden_reset_(ctx, SENSORS_SCREEN);
+    sensors_screen_logic(ctx);
+}
 
-    if (ctx->appCtx->filesScreenCtx->total_items > ctx->appCtx->filesScreenCtx->items_per_page) {
-        int scrollbar_x = window_x + window_w - 35;
-        int scrollbar_y = list_y + 3;
-        int scrollbar_h = list_h - 6;
+static void golden_about_(AppState *ctx) {
+    golden_reset_(ctx, ABOUT_SCREEN);
+    about_screen_logic(ctx);
+}
 
-        draw_rect(ctx, scrollbar_x, scrollbar_y, 20, scrollbar_h, CDE_BUTTON_COLOR);
-        draw_3d_border(ctx, scrollbar_x, scrollbar_y, 20, scrollbar_h, 1);
+static void golden_clip_edges_(AppState *ctx) {
+    golden_reset_(ctx, -1);
+    draw_rect(ctx, -20, 100, 60, 40, CDE_SELECTED_BG);                   // left
+    draw_rect(ctx, WINDOW_WIDTH - 40, 100, 60, 40, CDE_SUCCESS_COLOR);   // right
+    draw_rect(ctx, 200, -20, 60, 40, CDE_ERROR_COLOR);                   // top
+    draw_rect(ctx, 200, WINDOW_HEIGHT - 20, 60, 40, CDE_BUTTON_COLOR);   // bottom
+    draw_rect(ctx, -10, -10, 30, 30, CDE_BORDER_LIGHT);                  // corners
+    draw_rect(ctx, WINDOW_WIDTH - 20, WINDOW_HEIGHT - 20, 30, 30, CDE_BORDER_LIGHT);
+    draw_rect(ctx, -50, 300, WINDOW_WIDTH + 100, 10, CDE_PANEL_COLOR);   // wider than the screen
+    draw_3d_border(ctx, -2, 400, WINDOW_WIDTH + 4, 60, 0);
+    draw_text(ctx, -5, 500, "clipped left", CDE_SELECTED_TEXT);
+    draw_text(ctx, WINDOW_WIDTH - 50, 500, "clipped right", CDE_SELECTED_TEXT);
+    draw_text(ctx, 300, -10, "clipped top", CDE_SELECTED_TEXT);
+    draw_text(ctx, 300, WINDOW_HEIGHT - 10, "clipped bottom", CDE_SELECTED_TEXT);
+}
 
-        int thumb_h = (scrollbar_h * ctx->appCtx->filesScreenCtx->items_per_page) / ctx->appCtx->filesScreenCtx->
-                      total_items;
-        if (thumb_h < 30)
-            thumb_h = 30; // Minimum thumb size
-        int thumb_y = scrollbar_y;
-        if (ctx->appCtx->filesScreenCtx->total_items > ctx->appCtx->filesScreenCtx->items_per_page) {
-            thumb_y += ((scrollbar_h - thumb_h) * ctx->appCtx->filesScreenCtx->scroll_offset) / (
-                ctx->appCtx->filesScreenCtx->total_items - ctx->appCtx->filesScreenCtx->items_per_page);
-        }
+static void golden_degenerate_(AppState *ctx) {
+    golden_reset_(ctx, -1);
+    draw_rect(ctx, 100, 100, 0, 50, CDE_SELECTED_BG);   // zero width
+    draw_rect(ctx, 100, 100, 50, 0, CDE_SELECTED_BG);   // zero height
+    draw_rect(ctx, 200, 200, -30, -30, CDE_SELECTED_BG); // negative size
+    draw_rect(ctx, -100, -100, 50, 50, CDE_SELECTED_BG); // fully off screen
+    draw_rect(ctx, WINDOW_WIDTH, WINDOW_HEIGHT, 50, 50, CDE_SELECTED_BG);
+    draw_rect(ctx, 10, 10, 1, 1, CDE_BORDER_LIGHT);     // single pixel
+    draw_text(ctx, -FONT_WIDTH * 4, -FONT_HEIGHT, "gone", CDE_BORDER_LIGHT);
+    draw_text(ctx, 10, 40, "", CDE_BORDER_LIGHT);
+    draw_char(ctx, 10, 40, '\n', CDE_BORDER_LIGHT);
+}
 
-        draw_rect(ctx, scrollbar_x + 3, thumb_y, 14, thumb_h, CDE_PANEL_COLOR);
-        draw_3d_border(ctx, scrollbar_x + 3, thumb_y, 14, thumb_h, 0);
+static void golden_glyphs_(AppState *ctx) {
+    golden_reset_(ctx, -1);
+    const int per_row = (WINDOW_WIDTH - 20) / FONT_WIDTH;
+    for (int c = FONT_FIRST_CHAR; c <= FONT_LAST_CHAR; c++) {
+        const int i = c - FONT_FIRST_CHAR;
+        draw_char(ctx, 10 + (i % per_row) * FONT_WIDTH, 10 + (i / per_row) * FONT_HEIGHT, (char) c, CDE_BORDER_LIGHT);
+        draw_char(ctx, 10 + (i % per_row) * FONT_WIDTH, 200 + (i / per_row) * FONT_HEIGHT, (char) c, CDE_SELECTED_BG);
     }
+    draw_text_bold(ctx, 10, 400, "The quick brown fox jumps over the lazy dog", CDE_SUCCESS_COLOR);
+}
 
-    // draw_text(
-    //     ctx,
-    //     window_x + 15,
-    //     window_y + window_h - 35,
-    //     "UP/DOWN to navigate, SPACE does nothing, ESC to exit",
-    //     CDE_TEXT_COLOR
-    // );
-
-    draw_text(
-        ctx,
-        window_x + 15,
-        window_y + window_h - 35,
-        ctx->appCtx->filesScreenCtx->currentDirectory,
-        CDE_TEXT_COLOR
-    );
-
-    // Render everything
-    SDL_RenderClear(ctx->renderer);
-    SDL_UpdateTexture(ctx->framebuffer, NULL, ctx->pixels, WINDOW_WIDTH * sizeof(Uint16));
-    SDL_RenderTexture(ctx->renderer, ctx->framebuffer, NULL, NULL);
-    SDL_RenderPresent(ctx->renderer);
+static const struct {
+    char const *name;
+    void (*render)(AppState *ctx);
+} golden_cases[] = {
+    {"screen_welcome", golden_welcome_},
+    {"screen_menu", golden_menu_},
+    {"screen_menu_selected", golden_menu_selected_},
+    {"screen_keyboard", golden_keyboard_},
+    {"screen_sensors", golden_sensors_},
+    {"screen_about", golden_about_},
+    {"prim_clip_edges", golden_clip_edges_},
+    {"prim_degenerate", golden_degenerate_},
+    {"prim_glyphs", golden_glyphs_},
+};
 
-    ctx->appCtx->filesScreenCtx->shouldRepaint = false;
-    ctx->appCtx->keyboardScreenCtx->lastChange = SDL_GetTicks();
+static Uint64 golden_hash_(SDL_Surface const *surface) {
+    Uint64 hash = 0xcbf29ce484222325ULL; // FNV-1a
+    for (int y = 0; y < surface->h; y++) {
+        Uint8 const *row = (Uint8 const *) surface->pixels + y * surface->pitch;
+        for (int i = 0; i < surface->w * (int) sizeof(Uint16); i++) {
+            hash = (hash ^ row[i]) * 0x100000001b3ULL;
+        }
+    }
+    return hash;
 }
 
-void keyboard_screen_logic(AppState *ctx) {
-    if (ctx->appCtx->currentScreen != KEYBOARD_SCREEN) {
-        return;
+// Writes <dir>/<name>.diff.bmp if a reference <dir>/<name>.bmp of the same size is there: the reference, dimmed, as
+// context with every differing pixel painted red. Returns the number of differing pixels, -1 without a reference.
+static int golden_diff_(SDL_Surface const *actual, char const *dir, char const *name) {
+    char path[1024];
+    SDL_snprintf(path, sizeof(path), "%s/%s.bmp", dir, name);
+    SDL_Surface *loaded = SDL_LoadBMP(path);
+    if (!loaded) {
+        return -1;
     }
-    // First time here?
-    if (ctx->appCtx->keyboardScreenCtx->lastChange == 0) {
-        ctx->appCtx->keyboardScreenCtx->lastChange = SDL_GetTicks();
-        ctx->appCtx->keyboardScreenCtx->shouldRepaint = true;
+    SDL_Surface *expected = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGB565);
+    SDL_DestroySurface(loaded);
+    if (!expected || expected->w != actual->w || expected->h != actual->h) {
+        SDL_DestroySurface(expected);
+        return -1;
     }
-
-    if (!ctx->appCtx->keyboardScreenCtx->shouldRepaint) {
-        // Don't render screen if nothing changed.
-        return;
+    int mismatches = 0;
+    for (int y = 0; y < actual->h; y++) {
+        Uint16 const *a = (Uint16 const *) ((Uint8 const *) actual->pixels + y * actual->pitch);
+        Uint16 *e = (Uint16 *) ((Uint8 *) expected->pixels + y * expected->pitch);
+        for (int x = 0; x < actual->w; x++) {
+            if (a[x] != e[x]) {
+                e[x] = 0xF800;
+                mismatches++;
+            } else {
+                e[x] = (e[x] >> 1) & 0x7BEF;
+            }
+        }
     }
+    SDL_snprintf(path, sizeof(path), "%s/%s.diff.bmp", dir, name);
+    SDL_SaveBMP(expected, path);
+    SDL_DestroySurface(expected);
+    return mismatches;
+}
 
-    SDL_Log("Rendering keyboard screen\n");
-    ctx->appCtx->keyboardScreenCtx->shouldRepaint = false;
-
-    const int window_x = 30;
-    const int window_y = 30;
-    const int window_w = WINDOW_WIDTH - 60;
-    const int window_h = WINDOW_HEIGHT - 60;
-
-    draw_rect(ctx, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, CDE_BG_COLOR);
-
-    draw_rect(ctx, window_x, window_y, window_w, window_h, CDE_PANEL_COLOR);
-    draw_3d_border(ctx, window_x, window_y, window_w, window_h, 0);
-
-    const int title_h = 45;
-    draw_rect(ctx, window_x + 3, window_y + 3, window_w - 6, title_h, CDE_TITLE_BG);
-    draw_text_bold(ctx, window_x + 15, window_y + 11, "Random App - Keyboard", CDE_SELECTED_TEXT);
-
-    int content_y = 120;
-
-    char latestScanCodeAsString[128];
-    SDL_snprintf(latestScanCodeAsString, sizeof(latestScanCodeAsString), "0x%02X",
-             ctx->appCtx->keyboardScreenCtx->latestScancode);
-
-    char const *lines[] = {
-        "Keyboard test",
-        "Press any key, to see its scancode.",
-        "",
-        "Scan code of latest key pressed will be shown below:",
-        latestScanCodeAsString,
-        "",
-        "Press ESC key to return to menu.",
-        "(Press ESC to exit the app)",
-    };
-    for (int i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
-        draw_text_centered(ctx, window_x, content_y, window_w, lines[i], CDE_TEXT_COLOR);
-        content_y += FONT_HEIGHT + 8;
+// Reads <dir>/golden.txt into `expected` (indexed like golden_cases, 0 where a case has no line)
+static bool golden_load_manifest_(char const *dir, Uint64 *expected) {
+    char path[1024];
+    SDL_snprintf(path, sizeof(path), "%s/golden.txt", dir);
+    char *text = (char *) SDL_LoadFile(path, NULL);
+    if (!text) {
+        SDL_Log("golden: could not read %s: %s", path, SDL_GetError());
+        return false;
     }
-
-    // Render everything
-    SDL_RenderClear(ctx->renderer);
-    SDL_UpdateTexture(ctx->framebuffer, NULL, ctx->pixels, WINDOW_WIDTH * sizeof(Uint16));
-    SDL_RenderTexture(ctx->renderer, ctx->framebuffer, NULL, NULL);
-    SDL_RenderPresent(ctx->renderer);
+    for (char const *line = text; line; line = SDL_strchr(line, '\n') ? SDL_strchr(line, '\n') + 1 : NULL) {
+        char name[64];
+        char hash[17];
+        if (line[0] == '#' || SDL_sscanf(line, "%63s %16s", name, hash) != 2) {
+            continue;
+        }
+        for (size_t i = 0; i < SDL_arraysize(golden_cases); i++) {
+            if (SDL_strcmp(golden_cases[i].name, name) == 0) {
+                expected[i] = SDL_strtoull(hash, NULL, 16);
+            }
+        }
+    }
+    SDL_free(text);
+    return true;
 }
 
-void about_screen_logic(AppState *ctx) {
-    if (ctx->appCtx->currentScreen != ABOUT_SCREEN) {
-        return;
+static bool golden_save_manifest_(char const *dir, Uint64 const *hashes) {
+    char path[1024];
+    SDL_snprintf(path, sizeof(path), "%s/golden.txt", dir);
+    SDL_IOStream *io = SDL_IOFromFile(path, "w");
+    if (!io) {
+        SDL_Log("golden: could not write %s: %s", path, SDL_GetError());
+        return false;
     }
-    // Don't render screen if nothing changed.
-    bool shouldRender = true;
-
-    if (!shouldRender) {
-        return;
+    SDL_IOprintf(io, "# FNV-1a of each golden case rendered as RGB565, see golden_run in main_random_app.c\n");
+    for (size_t i = 0; i < SDL_arraysize(golden_cases); i++) {
+        SDL_IOprintf(io, "%s %016" SDL_PRIx64 "\n", golden_cases[i].name, hashes[i]);
     }
+    return SDL_CloseIO(io);
+}
 
-    const int window_x = 30;
-    const int window_y = 30;
-    const int window_w = WINDOW_WIDTH - 60;
-    const int window_h = WINDOW_HEIGHT - 60;
-
-    draw_rect(ctx, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, CDE_BG_COLOR);
-
-    draw_rect(ctx, window_x, window_y, window_w, window_h, CDE_PANEL_COLOR);
-    draw_3d_border(ctx, window_x, window_y, window_w, window_h, 0);
-
-    const int title_h = 45;
-    draw_rect(ctx, window_x + 3, window_y + 3, window_w - 6, title_h, CDE_TITLE_BG);
-    draw_text_bold(ctx, window_x + 15, window_y + 11, "Random App - About", CDE_SELECTED_TEXT);
-
-    int content_y = 120;
+static bool golden_check_(
+    SDL_Surface *actual, char const *dir, char const *name, const Uint64 actual_hash, const Uint64 expected, bool record
+) {
+    char path[1024];
 
-    char const *lines[] = {
-        "RandomApp is a simple demo application",
-        "showcasing SDL3 features on the WHY Badge.",
-        "",
-        "Created by FrankkieNL, 2025.",
-        "Version:",
-        APP_VERSION,
-        "",
-        "Visit https://badge.why2025.org for more info.",
-        "",
-        "Press any key to return.",
-    };
-    for (int i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
-        draw_text_centered(ctx, window_x, content_y, window_w, lines[i], CDE_TEXT_COLOR);
-        content_y += FONT_HEIGHT + 8;
+    if (record) {
+        SDL_snprintf(path, sizeof(path), "%s/%s.bmp", dir, name);
+        if (!SDL_SaveBMP(actual, path)) {
+            SDL_Log("golden %-22s could not write %s: %s", name, path, SDL_GetError());
+        }
+        SDL_Log("golden %-22s %016" SDL_PRIx64 " recorded", name, actual_hash);
+        return true;
+    }
+    if (actual_hash == expected) {
+        SDL_Log("golden %-22s %016" SDL_PRIx64 " ok", name, actual_hash);
+        return true;
     }
 
-    // Render everything
-    SDL_RenderClear(ctx->renderer);
-    SDL_UpdateTexture(ctx->framebuffer, NULL, ctx->pixels, WINDOW_WIDTH * sizeof(Uint16));
-    SDL_RenderTexture(ctx->renderer, ctx->framebuffer, NULL, NULL);
-    SDL_RenderPresent(ctx->renderer);
+    SDL_snprintf(path, sizeof(path), "%s/%s.actual.bmp", dir, name);
+    SDL_SaveBMP(actual, path);
+    const int mismatches = golden_diff_(actual, dir, name);
+    if (mismatches >= 0) {
+        SDL_Log("golden %-22s %016" SDL_PRIx64 " MISMATCH, expected %016" SDL_PRIx64 " (%d pixels), see %s/%s.diff.bmp",
+                name, actual_hash, expected, mismatches, dir, name);
+    } else {
+        SDL_Log("golden %-22s %016" SDL_PRIx64 " MISMATCH, expected %016" SDL_PRIx64 ", see %s",
+                name, actual_hash, expected, path);
+    }
+    return false;
 }
 
-void sensors_screen_logic(AppState *ctx) {
-    if (ctx->appCtx->currentScreen != SENSORS_SCREEN) {
-        return;
+static SDL_AppResult golden_run(AppState *ctx, char const *dir, bool record) {
+    Uint64 expected[SDL_arraysize(golden_cases)] = {0};
+    Uint64 hashes[SDL_arraysize(golden_cases)] = {0};
+    if (!record && !golden_load_manifest_(dir, expected)) {
+        return SDL_APP_FAILURE;
     }
-    // Don't render screen if nothing changed.
-    bool shouldRender = true;
-
-    if (!shouldRender) {
-        return;
+    // Always compared as RGB565, so every pixel format is checked against the same hashes
+    SDL_Surface *actual = SDL_CreateSurface(WINDOW_WIDTH, WINDOW_HEIGHT, SDL_PIXELFORMAT_RGB565);
+    const SDL_Rect all = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    if (!actual) {
+        SDL_Log("golden: could not create comparison surface: %s", SDL_GetError());
+        return SDL_APP_FAILURE;
     }
 
-    const int window_x = 30;
-    const int window_y = 30;
-    const int window_w = WINDOW_WIDTH - 60;
-    const int window_h = WINDOW_HEIGHT - 60;
-
-    draw_rect(ctx, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, CDE_BG_COLOR);
-
-    draw_rect(ctx, window_x, window_y, window_w, window_h, CDE_PANEL_COLOR);
-    draw_3d_border(ctx, window_x, window_y, window_w, window_h, 0);
-
-    const int title_h = 45;
-    draw_rect(ctx, window_x + 3, window_y + 3, window_w - 6, title_h, CDE_TITLE_BG);
-    draw_text_bold(ctx, window_x + 15, window_y + 11, "Random App - Sensors", CDE_SELECTED_TEXT);
-
-    int content_y = 120;
-
-#ifdef WHY_BADGE
-    char sensor1[128];
-    char sensor2[128];
-    if (ctx->appCtx->sensorsScreenCtx->orientationSensor != NULL) {
-        orientation_device_t *orientation_device = ctx->appCtx->sensorsScreenCtx->orientationSensor;
-        SDL_snprintf(sensor1, sizeof(sensor1), "orientation: %d", orientation_device->_get_orientation(orientation_device));
-        SDL_snprintf(sensor2, sizeof(sensor2), "orientation degress: %d",
-                 orientation_device->_get_orientation_degrees(orientation_device));
+    int failures = 0;
+    for (size_t i = 0; i < SDL_arraysize(golden_cases); i++) {
+        golden_cases[i].render(ctx);
+        flush_frame_(ctx);
+        pixels_to_rgb565_(ctx->pixels, &all, actual->pixels, actual->pitch);
+        hashes[i] = golden_hash_(actual);
+        if (!golden_check_(actual, dir, golden_cases[i].name, hashes[i], expected[i], record)) {
+            failures++;
+        }
     }
-    char sensor3[128];
-    char sensor4[128];
-    char sensor5[128];
-    char sensor6[128];
-    if (ctx->appCtx->sensorsScreenCtx->gasSensor != NULL) {
-        gas_device_t *gas = ctx->appCtx->sensorsScreenCtx->gasSensor;
-        SDL_snprintf(sensor3, sizeof(sensor3), "Temperature in Celsius: %.2f \n", gas->_get_temperature(gas));
-        SDL_snprintf(sensor4, sizeof(sensor4), "Humidity in Rel. Percentage: %.2f \n", gas->_get_humidity(gas));
-        SDL_snprintf(sensor5, sizeof(sensor5), "Pressure in Pascal: %.2f \n", gas->_get_pressure(gas));
-        SDL_snprintf(sensor6, sizeof(sensor6), "Gas Resistance in Ohm: %.2f \n", gas->_get_gas_resistance(gas));
-    }
-    char const *lines[] = {
-        "Sensors screen",
-        "",
-        "BMI 270 - Orientation sensor",
-        sensor1,
-        sensor2,
-        "",
-        "BME 690 - Gas sensor",
-        sensor3,
-        sensor4,
-        sensor5,
-        sensor6,
-        "",
-        "Press any key to return.",
-    };
-#else
-    char const *lines[] = {
-        "Sensors screen",
-        "No sensors found, ",
-        "as this is not a WHY Badge build of this app",
-        "Press any key to return.",
-    };
-#endif
-
-    for (int i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
-        draw_text_centered(ctx, window_x, content_y, window_w, lines[i], CDE_TEXT_COLOR);
-        content_y += FONT_HEIGHT + 8;
+    SDL_DestroySurface(actual);
+    if (record && !golden_save_manifest_(dir, hashes)) {
+        return SDL_APP_FAILURE;
     }
 
-    // Render everything
-    SDL_RenderClear(ctx->renderer);
-    SDL_UpdateTexture(ctx->framebuffer, NULL, ctx->pixels, WINDOW_WIDTH * sizeof(Uint16));
-    SDL_RenderTexture(ctx->renderer, ctx->framebuffer, NULL, NULL);
-    SDL_RenderPresent(ctx->renderer);
+    SDL_Log("golden: %d of %d cases failed", failures, (int) SDL_arraysize(golden_cases));
+    return failures == 0 ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
 }
 
 static SDL_AppResult handle_key_event_(AppState *ctx, SDL_Scancode key_code) {
     SDL_Log("handle_key_event_\n");
+#ifdef ENABLE_TRACE
+    if (key_code == SDL_SCANCODE_F12) {
+        trace_dump(TRACE_OUTPUT_PATH);
+        return SDL_APP_CONTINUE;
+    }
+#endif
+    if (key_code == SDL_SCANCODE_F3) {
+        ctx->hud.visible = !ctx->hud.visible;
+        ctx->hud.lastDraw = 0;
+        if (!ctx->hud.visible) {
+            // Bring back what the overlay covered
+            request_repaint(ctx);
+        }
+        return SDL_APP_CONTINUE;
+    }
     if (ctx->appCtx->currentScreen != KEYBOARD_SCREEN) {
         switch (key_code) {
             /* Quit. */
@@ -936,12 +1462,9 @@ static SDL_AppResult handle_key_event_(AppState *ctx, SDL_Scancode key_code) {
     if (ctx->appCtx->currentScreen == KEYBOARD_SCREEN) {
         // Update latest scancode
         ctx->appCtx->keyboardScreenCtx->latestScancode = key_code;
-        ctx->appCtx->keyboardScreenCtx->shouldRepaint = true;
         // If ESC pressed, go back to menu
         if (key_code == SDL_SCANCODE_ESCAPE) {
             ctx->appCtx->currentScreen = MENU_SCREEN;
-            // Force redraw
-            ctx->appCtx->menuScreenCtx->shouldRepaint = true;
         }
         return SDL_APP_CONTINUE;
     }
@@ -949,23 +1472,16 @@ static SDL_AppResult handle_key_event_(AppState *ctx, SDL_Scancode key_code) {
     if (ctx->appCtx->currentScreen == ABOUT_SCREEN) {
         // Any key to continue
         ctx->appCtx->currentScreen = MENU_SCREEN;
-        // Force redraw
-        ctx->appCtx->welcomeScreenCtx->lastChange = 0;
         return SDL_APP_CONTINUE;
     }
 
     if (ctx->appCtx->currentScreen == SENSORS_SCREEN) {
         // Any key to continue
         ctx->appCtx->currentScreen = MENU_SCREEN;
-        // Force redraw
-        ctx->appCtx->welcomeScreenCtx->lastChange = 0;
         return SDL_APP_CONTINUE;
     }
 
     if (ctx->appCtx->currentScreen == FILES_SCREEN) {
-        // Force redraw
-        ctx->appCtx->filesScreenCtx->shouldRepaint = true;
-        ctx->appCtx->welcomeScreenCtx->lastChange = 0;
         files_screen_handle_key(ctx, key_code);
         return SDL_APP_CONTINUE;
     }
@@ -985,28 +1501,48 @@ static SDL_AppResult handle_hat_event_(AppState *appstate, Uint8 hat_value) {
     return SDL_APP_CONTINUE;
 }
 
+static const struct {
+    char const *name;
+    void (*logic)(AppState *ctx);
+} screens[] = {
+    [WELCOME_SCREEN] = {"welcome_screen_logic", welcome_screen_logic},
+    [MENU_SCREEN] = {"menu_screen_logic", menu_screen_logic},
+    [KEYBOARD_SCREEN] = {"keyboard_screen_logic", keyboard_screen_logic},
+    [FILES_SCREEN] = {"files_screen_logic", files_screen_logic},
+    [SENSORS_SCREEN] = {"sensors_screen_logic", sensors_screen_logic},
+    [ABOUT_SCREEN] = {"about_screen_logic", about_screen_logic},
+};
+
 SDL_AppResult SDL_AppIterate(void *appstate) {
     // SDL_Log("SDL_AppIterate\n");
     AppState *as = (AppState *) appstate;
     RandomAppContext *ctx = as->appCtx;
-    Uint64 const now = SDL_GetTicks();
+    Uint64 const start = SDL_GetTicksNS();
 
-    switch (ctx->currentScreen) {
-        case WELCOME_SCREEN: welcome_screen_logic(appstate);
-            break;
-        case MENU_SCREEN: menu_screen_logic(appstate);
-            break;
-        case KEYBOARD_SCREEN: keyboard_screen_logic(appstate);
-            break;
-        case FILES_SCREEN: files_screen_logic(appstate);
-            break;
-        case SENSORS_SCREEN: sensors_screen_logic(appstate);
-            break;
-        case ABOUT_SCREEN: about_screen_logic(appstate);
-            break;
-        default: break;
+    const SDL_AppResult replayed = replay_pump(as, SDL_AppEvent);
+    if (replayed != SDL_APP_CONTINUE) {
+        return replayed;
     }
 
+    watchdog_frame_begin();
+    TRACE_BEGIN("SDL_AppIterate");
+    alloc_stats_frame_begin();
+    if (as->presentPending && dl_pipeline_idle(&as->pipeline)) {
+        present_pending_(as);
+    }
+    if (ctx->currentScreen >= 0 && ctx->currentScreen < (int) SDL_arraysize(screens)) {
+        TRACE_BEGIN(screens[ctx->currentScreen].name);
+        ALLOC_TAG_PUSH(screens[ctx->currentScreen].name);
+        screens[ctx->currentScreen].logic(as);
+        ALLOC_TAG_POP();
+        TRACE_END(screens[ctx->currentScreen].name);
+    }
+    hud_frame_end_(as, start);
+    alloc_stats_frame_end();
+    TRACE_END("SDL_AppIterate");
+    watchdog_frame_end();
+    replay_frame_end();
+
     return SDL_APP_CONTINUE;
 }
 
@@ -1014,6 +1550,9 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
     //SDL_Log("SDL_AppEvent\n");
     //RandomAppContext *ctx = ((AppState *) appstate)->appCtx;
     AppState *as = (AppState *) appstate;
+    if (replay_filter_event(event)) {
+        return SDL_APP_CONTINUE;
+    }
     switch (event->type) {
         case SDL_EVENT_QUIT: return SDL_APP_SUCCESS;
         case SDL_EVENT_JOYSTICK_ADDED:
@@ -1041,7 +1580,14 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
 }
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
+    alloc_stats_install();
     SDL_Log("SDL_AppInit\n");
+    TRACE_BEGIN("SDL_AppInit");
+
+    // Input recording / replay; has to pick the video driver before SDL_Init
+    if (!replay_parse_args(argc, argv)) {
+        return SDL_APP_FAILURE;
+    }
 
 #ifndef WHY_BADGE
     if (!SDL_SetAppMetadata(APP_NAME, APP_VERSION, APP_ID)) {
@@ -1067,12 +1613,44 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
         return SDL_APP_FAILURE;
     }
     as->appCtx->currentScreen = WELCOME_SCREEN;
+#ifdef ENABLE_INDEX8
+    px_palette_seed(ui_palette_, SDL_arraysize(ui_palette_));
+#endif
 
     as->appCtx->welcomeScreenCtx = (WelcomeScreenContext *) SDL_calloc(1, sizeof(WelcomeScreenContext));
     as->appCtx->menuScreenCtx = (MenuScreenContext *) SDL_calloc(1, sizeof(MenuScreenContext));
     as->appCtx->filesScreenCtx = (FilesScreenContext *) SDL_calloc(1, sizeof(FilesScreenContext));
     as->appCtx->keyboardScreenCtx = (KeyboardScreenContext *) SDL_calloc(1, sizeof(KeyboardScreenContext));
     as->appCtx->sensorsScreenCtx = (SensorsScreenContext *) SDL_calloc(1, sizeof(SensorsScreenContext));
+    as->appCtx->aboutScreenCtx = (AboutScreenContext *) SDL_calloc(1, sizeof(AboutScreenContext));
+
+    // Golden image check: render offscreen, compare, and quit without ever opening a window
+    char const *golden_dir = NULL;
+    bool golden_record = false;
+    Uint32 frame_budget_ms = WATCHDOG_BUDGET_MS;
+    int raster_threads = -1;
+    bool render_thread = true;
+    for (int i = 1; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            golden_dir = argv[++i];
+        } else if (SDL_strcmp(argv[i], "--record") == 0) {
+            golden_record = true;
+        } else if (SDL_strcmp(argv[i], "--frame-budget") == 0 && i + 1 < argc) {
+            frame_budget_ms = (Uint32) SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--raster-threads") == 0 && i + 1 < argc) {
+            raster_threads = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--sync-render") == 0) {
+            render_thread = false;
+        }
+    }
+    if (golden_dir) {
+        as->pixels = (px_t *) SDL_calloc(WINDOW_WIDTH * WINDOW_HEIGHT, sizeof(px_t));
+        if (!as->pixels || !dl_raster_init(&as->raster, as->pixels, WINDOW_WIDTH, WINDOW_HEIGHT, raster_threads)) {
+            return SDL_APP_FAILURE;
+        }
+        dl_pipeline_start(&as->pipeline, &as->raster, false);
+        return golden_run(as, golden_dir, golden_record);
+    }
 
     //Create window first
     as->window = SDL_CreateWindow(APP_NAME, WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_FLAGS);
@@ -1103,13 +1681,12 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
 
     // Check renderer properties
     SDL_PropertiesID props = SDL_GetRendererProperties(as->renderer);
+    SDL_PixelFormat const *formats = NULL;
     if (props) {
         char const *name = SDL_GetStringProperty(props, SDL_PROP_RENDERER_NAME_STRING, "Unknown");
         SDL_Log("Renderer: %s\n", name);
 
-        SDL_PixelFormat const *formats =
-                (SDL_PixelFormat const *)
-                SDL_GetPointerProperty(props, SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, NULL);
+        formats = (SDL_PixelFormat const *) SDL_GetPointerProperty(props, SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, NULL);
         if (formats) {
             SDL_Log("Supported texture formats:\n");
             for (int j = 0; formats[j] != SDL_PIXELFORMAT_UNKNOWN; j++) {
@@ -1118,9 +1695,16 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
         }
     }
 
+    as->textureFormat = choose_texture_format_(formats);
+    if (as->textureFormat == PX_FORMAT) {
+        SDL_Log("Framebuffer: %s, uploaded as is\n", SDL_GetPixelFormatName(PX_FORMAT));
+    } else {
+        SDL_Log("Framebuffer: rendering %s, converting to %s on upload\n", SDL_GetPixelFormatName(PX_FORMAT),
+                SDL_GetPixelFormatName(as->textureFormat));
+    }
     as->framebuffer = SDL_CreateTexture(
         as->renderer,
-        SDL_PIXELFORMAT_RGB565,
+        as->textureFormat,
         SDL_TEXTUREACCESS_STREAMING,
         WINDOW_WIDTH,
         WINDOW_HEIGHT
@@ -1134,7 +1718,7 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
         return SDL_APP_FAILURE;
     }
 
-    as->pixels = (Uint16 *) SDL_calloc(WINDOW_WIDTH * WINDOW_HEIGHT, sizeof(Uint16));
+    as->pixels = (px_t *) SDL_calloc(WINDOW_WIDTH * WINDOW_HEIGHT, sizeof(px_t));
     if (!as->pixels) {
         SDL_Log("Could not allocate pixel buffer!\n");
         SDL_DestroyRenderer(as->renderer);
@@ -1142,6 +1726,10 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
         SDL_free(as);
         return SDL_APP_FAILURE;
     }
+    if (!dl_raster_init(&as->raster, as->pixels, WINDOW_WIDTH, WINDOW_HEIGHT, raster_threads)) {
+        return SDL_APP_FAILURE;
+    }
+    dl_pipeline_start(&as->pipeline, &as->raster, render_thread);
 
 #ifdef WHY_BADGE
     //sleep(5);
@@ -1172,11 +1760,17 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
     }
 #endif
 
+    watchdog_start(frame_budget_ms);
+    TRACE_END("SDL_AppInit");
     return SDL_APP_CONTINUE;
 }
 
 void SDL_AppQuit(void *appstate, SDL_AppResult result) {
     SDL_Log("SDL_AppQuit\n");
+    replay_close();
+    trace_dump(TRACE_OUTPUT_PATH);
+    watchdog_stop();
+    watchdog_dump(WATCHDOG_OUTPUT_PATH);
     if (joystick) {
         SDL_CloseJoystick(joystick);
     }
@@ -1184,15 +1778,21 @@ void SDL_AppQuit(void *appstate, SDL_AppResult result) {
         AppState *as = (AppState *) appstate;
         SDL_free(as->appCtx->keyboardScreenCtx);
         SDL_free(as->appCtx->sensorsScreenCtx);
+        SDL_free(as->appCtx->aboutScreenCtx);
         SDL_free(as->appCtx->filesScreenCtx->entries);
         SDL_free(as->appCtx->filesScreenCtx);
         SDL_free(as->appCtx->menuScreenCtx);
         SDL_free(as->appCtx->welcomeScreenCtx);
         SDL_free(as->appCtx);
+        dl_pipeline_stop(&as->pipeline);
+        dl_free(&as->dedup.last);
+        dl_raster_quit(&as->raster);
+        dl_free(&as->frame);
         SDL_free(as->pixels);
         SDL_DestroyTexture(as->framebuffer);
         SDL_DestroyRenderer(as->renderer);
         SDL_DestroyWindow(as->window);
         SDL_free(as);
     }
+    alloc_stats_report();
 }
@@ -13,6 +13,8 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 
+#include "replay.h"
+
 #define STEP_RATE_IN_MILLISECONDS  125
 #define SNAKE_BLOCK_SIZE_IN_PIXELS 24
 #define SDL_WINDOW_WIDTH           (SNAKE_BLOCK_SIZE_IN_PIXELS * SNAKE_GAME_WIDTH)
@@ -209,12 +211,17 @@ static SDL_AppResult handle_hat_event_(SnakeContext *ctx, Uint8 hat) {
 SDL_AppResult SDL_AppIterate(void *appstate) {
     AppState     *as  = (AppState *)appstate;
     SnakeContext *ctx = &as->snake_ctx;
-    Uint64 const  now = SDL_GetTicks();
     SDL_FRect     r;
     unsigned      i;
     unsigned      j;
     int           ct;
 
+    SDL_AppResult const replayed = replay_pump(as, SDL_AppEvent);
+    if (replayed != SDL_APP_CONTINUE) {
+        return replayed;
+    }
+    Uint64 const now = replay_ticks();
+
     // run game logic if we're at or past the time to run it.
     // if we're _really_ behind the time to run it, run it
     // several times.
@@ -243,6 +250,7 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
     set_rect_xy_(&r, ctx->head_xpos, ctx->head_ypos);
     SDL_RenderFillRect(as->renderer, &r);
     SDL_RenderPresent(as->renderer);
+    replay_frame_end();
     return SDL_APP_CONTINUE;
 }
 
@@ -259,6 +267,11 @@ static const struct {
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
     size_t i;
 
+    // Input recording / replay (--record-events FILE, --replay FILE [--fast]); seeds SDL_rand too
+    if (!replay_parse_args(argc, argv)) {
+        return SDL_APP_FAILURE;
+    }
+
     if (!SDL_SetAppMetadata("Example Snake game", "1.0", "com.example.Snake")) {
         return SDL_APP_FAILURE;
     }
@@ -325,13 +338,16 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
     }
 
     snake_initialize(&as->snake_ctx);
-    as->last_step = SDL_GetTicks();
+    as->last_step = replay_ticks();
 
     return SDL_APP_CONTINUE;
 }
 
 SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
     SnakeContext *ctx = &((AppState *)appstate)->snake_ctx;
+    if (replay_filter_event(event)) {
+        return SDL_APP_CONTINUE;
+    }
     switch (event->type) {
         case SDL_EVENT_QUIT: return SDL_APP_SUCCESS;
         case SDL_EVENT_JOYSTICK_ADDED:
@@ -356,6 +372,7 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
 }
 
 void SDL_AppQuit(void *appstate, SDL_AppResult result) {
+    replay_close();
     if (joystick) {
         SDL_CloseJoystick(joystick);
     }
@@ -0,0 +1,184 @@
+//
+// Pixel formats and the span kernels the software rasterizers are built from.
+//
+// Every format has its own storage type: RGB565 (Uint16), XRGB8888 (Uint32) and INDEX8 (Uint8, an index into
+// px_palette). PX_DEFINE_KERNELS_ stamps out the fill/glyph/copy loops once per storage type and the px_* macros
+// pick one with _Generic on the destination pointer, so every call compiles straight to the loop for that format;
+// nothing is decided per pixel.
+//
+// px_t and px_encode() are the format this build renders in: RGB565 by default, or INDEX8 / XRGB8888 with
+// ENABLE_INDEX8 / ENABLE_XRGB8888 (desktop randomapp defaults to XRGB8888, the native format of desktop renderers).
+// Code that must produce a specific format (the badge compositor framebuffer is always RGB565) calls px_rgb565()
+// and friends directly.
+//
+//     px_t color = px_encode(0x0078D4);
+//     px_fill(row + x, w, color);
+//     written += px_glyph_row(row + x, font_bits, 0, FONT_WIDTH, color);
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#if defined(ENABLE_INDEX8) && defined(ENABLE_XRGB8888)
+#error "ENABLE_INDEX8 and ENABLE_XRGB8888 are mutually exclusive"
+#endif
+
+// The one RGB888 -> RGB565 conversion: truncating, bit-identical to rgb888_to_rgb565() in badgevms/framebuffer.h.
+static inline Uint16 px_rgb565(const Uint32 rgb888) {
+    return (Uint16) (((rgb888 >> 8) & 0xF800) | ((rgb888 >> 5) & 0x07E0) | ((rgb888 >> 3) & 0x001F));
+}
+
+static inline Uint16 px_rgb565_from_rgb(const Uint8 r, const Uint8 g, const Uint8 b) {
+    return (Uint16) (((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+static inline Uint32 px_xrgb8888(const Uint32 rgb888) {
+    return 0xFF000000u | rgb888;
+}
+
+//
+// INDEX8 palette. Starts empty; px_palette_index() hands out the next free slot for a new color, or the nearest
+// existing one once all 256 are taken. Seed it with the colors that matter so they get exact entries (and index 0
+// is what a zeroed buffer shows).
+//
+
+#define PX_PALETTE_SIZE 256
+
+static struct {
+    Uint32 rgb888[PX_PALETTE_SIZE];
+    Uint16 rgb565[PX_PALETTE_SIZE];
+    Uint32 xrgb8888[PX_PALETTE_SIZE];
+    int count;
+    int last; // most drawing repeats the previous color
+} px_palette;
+
+static inline Uint8 px_palette_index(const Uint32 rgb888) {
+    if (px_palette.last < px_palette.count && px_palette.rgb888[px_palette.last] == rgb888) {
+        return (Uint8) px_palette.last;
+    }
+    int best = 0;
+    int best_dist = SDL_MAX_SINT32;
+    for (int i = 0; i < px_palette.count && best_dist != 0; i++) {
+        const int dr = (int) ((px_palette.rgb888[i] >> 16) & 0xFF) - (int) ((rgb888 >> 16) & 0xFF);
+        const int dg = (int) ((px_palette.rgb888[i] >> 8) & 0xFF) - (int) ((rgb888 >> 8) & 0xFF);
+        const int db = (int) (px_palette.rgb888[i] & 0xFF) - (int) (rgb888 & 0xFF);
+        const int dist = dr * dr + dg * dg + db * db;
+        if (dist < best_dist) {
+            best = i;
+            best_dist = dist;
+        }
+    }
+    if (best_dist != 0 && px_palette.count < PX_PALETTE_SIZE) {
+        best = px_palette.count++;
+        px_palette.rgb888[best] = rgb888 & 0xFFFFFF;
+        px_palette.rgb565[best] = px_rgb565(rgb888);
+        px_palette.xrgb8888[best] = px_xrgb8888(rgb888 & 0xFFFFFF);
+    }
+    px_palette.last = best;
+    return (Uint8) best;
+}
+
+static inline void px_palette_seed(Uint32 const *rgb888, int count) {
+    for (int i = 0; i < count; i++) {
+        px_palette_index(rgb888[i]);
+    }
+}
+
+//
+// Kernels, one set per storage type. The glyph kernel takes a 12-bit font row (MSB = leftmost pixel) and writes
+// `color` where bits are set in columns [from, to), returning how many it wrote; it selects with a mask instead of
+// branching on every bit.
+//
+
+#define PX_DEFINE_KERNELS_(suffix, type)                                                                    \
+    static inline void px_fill_##suffix(type *dst, int n, type color) {                                     \
+        for (int i = 0; i < n; i++) {                                                                       \
+            dst[i] = color;                                                                                 \
+        }                                                                                                   \
+    }                                                                                                       \
+    static inline int px_glyph_row_##suffix(type *dst, Uint16 bits, int from, int to, type color) {         \
+        int written = 0;                                                                                    \
+        for (int i = from; i < to; i++) {                                                                   \
+            const type bit = (type) ((bits >> (11 - i)) & 1);                                               \
+            const type mask = (type) -bit;                                                                  \
+            dst[i] = (type) ((dst[i] & ~mask) | (color & mask));                                            \
+            written += bit;                                                                                 \
+        }                                                                                                   \
+        return written;                                                                                     \
+    }                                                                                                       \
+    static inline void px_copy_##suffix(type *dst, type const *src, int n) {                                \
+        SDL_memcpy(dst, src, (size_t) n * sizeof(type));                                                    \
+    }
+
+PX_DEFINE_KERNELS_(u8, Uint8)
+PX_DEFINE_KERNELS_(u16, Uint16)
+PX_DEFINE_KERNELS_(u32, Uint32)
+#undef PX_DEFINE_KERNELS_
+
+#define PX_SELECT_(dst, name) _Generic((dst), Uint8 *: name##_u8, Uint16 *: name##_u16, Uint32 *: name##_u32)
+
+#define px_fill(dst, n, color)                      PX_SELECT_(dst, px_fill)(dst, n, color)
+#define px_glyph_row(dst, bits, from, to, color)    PX_SELECT_(dst, px_glyph_row)(dst, bits, from, to, color)
+#define px_copy(dst, src, n)                        PX_SELECT_(dst, px_copy)(dst, src, n)
+
+// Expand a row of this build's pixels for an RGB565 or XRGB8888 consumer (texture upload, golden images).
+static inline void px_row_to_rgb565_u8(Uint16 *dst, Uint8 const *src, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = px_palette.rgb565[src[i]];
+    }
+}
+
+static inline void px_row_to_rgb565_u16(Uint16 *dst, Uint16 const *src, int n) {
+    px_copy_u16(dst, src, n);
+}
+
+static inline void px_row_to_rgb565_u32(Uint16 *dst, Uint32 const *src, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = px_rgb565(src[i]);
+    }
+}
+
+static inline void px_row_to_xrgb8888_u8(Uint32 *dst, Uint8 const *src, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = px_palette.xrgb8888[src[i]];
+    }
+}
+
+static inline void px_row_to_xrgb8888_u16(Uint32 *dst, Uint16 const *src, int n) {
+    for (int i = 0; i < n; i++) {
+        // Replicate the top bits into the bottom so white stays white
+        const Uint32 r = (src[i] >> 11) & 0x1F;
+        const Uint32 g = (src[i] >> 5) & 0x3F;
+        const Uint32 b = src[i] & 0x1F;
+        dst[i] = 0xFF000000u | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+    }
+}
+
+static inline void px_row_to_xrgb8888_u32(Uint32 *dst, Uint32 const *src, int n) {
+    px_copy_u32(dst, src, n);
+}
+
+#define PX_SELECT_SRC_(src, name) _Generic((src), Uint8 const *: name##_u8, Uint16 const *: name##_u16, \
+                                                  Uint32 const *: name##_u32)
+
+#define px_row_to_rgb565(dst, src, n)   PX_SELECT_SRC_(src, px_row_to_rgb565)(dst, src, n)
+#define px_row_to_xrgb8888(dst, src, n) PX_SELECT_SRC_(src, px_row_to_xrgb8888)(dst, src, n)
+
+//
+// This build's render format.
+//
+
+#if defined(ENABLE_INDEX8)
+typedef Uint8 px_t;
+#define PX_FORMAT SDL_PIXELFORMAT_INDEX8
+static inline px_t px_encode(const Uint32 rgb888) { return px_palette_index(rgb888); }
+#elif defined(ENABLE_XRGB8888)
+typedef Uint32 px_t;
+#define PX_FORMAT SDL_PIXELFORMAT_XRGB8888
+static inline px_t px_encode(const Uint32 rgb888) { return px_xrgb8888(rgb888); }
+#else
+typedef Uint16 px_t;
+#define PX_FORMAT SDL_PIXELFORMAT_RGB565
+static inline px_t px_encode(const Uint32 rgb888) { return px_rgb565(rgb888); }
+#endif
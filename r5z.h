@@ -0,0 +1,232 @@
+//
+// R5Z: compressed RGB565 images, decoded straight into an RGB565 framebuffer.
+//
+// A QOI-style byte stream over RGB565 pixels in raster order, built so the decoder is a tight loop: flat areas
+// become fills, everything else is one or two byte ops against the previous pixel. An optional alpha plane
+// (run-length coded, stored after the pixels) makes it usable for sprites. tools/r5zenc.c converts PNGs.
+//
+//     Header, 16 bytes:  "R5Z1"  u16 width  u16 height  u32 alpha_offset (0 = opaque)  u32 size of the file
+//
+//     00iiiiii           INDEX  color from the 64-entry table of recently seen colors
+//     01rrggbb           DIFF   r, g, b each -2..1 from the previous pixel, in their own 5/6/5-bit units
+//     10gggggg rrrrbbbb  LUMA   g -32..31, then r - g/2 and b - g/2 -8..7
+//     11nnnnnn           RUN    previous pixel 1..62 more times (n = count - 1, up to 61)
+//     11111110 lo hi     RGB    literal RGB565, little-endian
+//     11111111 lo hi     LONG   previous pixel 63..65598 more times (value = count - 63)
+//
+//     Alpha plane: (count - 1, alpha) byte pairs covering the image in raster order.
+//
+// Channel arithmetic wraps (mod 32/64/32). Runs may cross rows. The previous pixel starts as 0x0000.
+//
+//     r5z_blit(background_r5z, background_r5z_len, fb->pixels, fb->w, fb->h, 0, 0);
+//     r5z_blit_clipped(pin_r5z, pin_r5z_len, fb->pixels, fb->w, fb->h, x, y, &damage, 255);
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include "pixfmt.h"
+
+#define R5Z_HEADER_SIZE 16
+#define R5Z_MAX_WIDTH   1024 // decode scratch is one row on the stack
+
+#define R5Z_OP_INDEX 0x00
+#define R5Z_OP_DIFF  0x40
+#define R5Z_OP_LUMA  0x80
+#define R5Z_OP_RUN   0xC0
+#define R5Z_OP_RGB   0xFE
+#define R5Z_OP_LONG  0xFF
+
+#define R5Z_RUN_MAX      62
+#define R5Z_LONG_RUN_MAX (63 + 0xFFFF)
+
+static inline int r5z_hash(const Uint16 c) {
+    return ((c >> 11) * 3 + ((c >> 5) & 0x3F) * 5 + (c & 0x1F) * 7) & 63;
+}
+
+static inline Uint16 r5z_u16_(Uint8 const *p) {
+    return (Uint16) (p[0] | (p[1] << 8));
+}
+
+static inline Uint32 r5z_u32_(Uint8 const *p) {
+    return (Uint32) p[0] | ((Uint32) p[1] << 8) | ((Uint32) p[2] << 16) | ((Uint32) p[3] << 24);
+}
+
+static inline bool r5z_info(Uint8 const *data, const size_t size, int *width, int *height) {
+    if (size < R5Z_HEADER_SIZE || SDL_memcmp(data, "R5Z1", 4) != 0 || r5z_u32_(&data[12]) != size) {
+        return false;
+    }
+    *width = r5z_u16_(&data[4]);
+    *height = r5z_u16_(&data[6]);
+    return *width > 0 && *width <= R5Z_MAX_WIDTH && *height > 0;
+}
+
+typedef struct {
+    Uint8 const *pos;
+    Uint8 const *end;
+    Uint16 prev;
+    Uint32 run;
+    Uint16 index[64];
+    // Alpha plane
+    Uint8 const *alpha_pos;
+    Uint8 const *alpha_end;
+    Uint32 alpha_run;
+    Uint8 alpha;
+} r5z_decoder_t;
+
+// Decode the next `n` pixels into `dst`. False if the stream ends early or is corrupt.
+static inline bool r5z_decode_pixels_(r5z_decoder_t *d, Uint16 *dst, int n) {
+    int x = 0;
+    while (x < n) {
+        if (d->run > 0) {
+            const int count = (int) SDL_min(d->run, (Uint32) (n - x));
+            px_fill_u16(&dst[x], count, d->prev);
+            d->run -= (Uint32) count;
+            x += count;
+            continue;
+        }
+        if (d->pos >= d->end) {
+            return false;
+        }
+        const Uint8 op = *d->pos++;
+        Uint16 c = d->prev;
+        if (op >= R5Z_OP_RGB) {
+            if (d->end - d->pos < 2) {
+                return false;
+            }
+            const Uint16 value = r5z_u16_(d->pos);
+            d->pos += 2;
+            if (op == R5Z_OP_LONG) {
+                d->run = 63u + value;
+                continue;
+            }
+            c = value;
+        } else if (op >= R5Z_OP_RUN) {
+            d->run = (Uint32) (op & 0x3F) + 1;
+            continue;
+        } else if (op < R5Z_OP_DIFF) {
+            c = d->index[op];
+        } else if (op < R5Z_OP_LUMA) {
+            const int r = ((c >> 11) + ((op >> 4) & 3) - 2) & 0x1F;
+            const int g = (((c >> 5) & 0x3F) + ((op >> 2) & 3) - 2) & 0x3F;
+            const int b = ((c & 0x1F) + (op & 3) - 2) & 0x1F;
+            c = (Uint16) ((r << 11) | (g << 5) | b);
+        } else {
+            if (d->pos >= d->end) {
+                return false;
+            }
+            const Uint8 rb = *d->pos++;
+            const int dg = (op & 0x3F) - 32;
+            const int r = ((c >> 11) + dg / 2 + (rb >> 4) - 8) & 0x1F;
+            const int g = (((c >> 5) & 0x3F) + dg) & 0x3F;
+            const int b = ((c & 0x1F) + dg / 2 + (rb & 0x0F) - 8) & 0x1F;
+            c = (Uint16) ((r << 11) | (g << 5) | b);
+        }
+        d->index[r5z_hash(c)] = c;
+        d->prev = c;
+        dst[x++] = c;
+    }
+    return true;
+}
+
+static inline bool r5z_decode_alpha_(r5z_decoder_t *d, Uint8 *dst, int n) {
+    int x = 0;
+    while (x < n) {
+        if (d->alpha_run == 0) {
+            if (d->alpha_end - d->alpha_pos < 2) {
+                return false;
+            }
+            d->alpha_run = (Uint32) d->alpha_pos[0] + 1;
+            d->alpha = d->alpha_pos[1];
+            d->alpha_pos += 2;
+        }
+        const int count = (int) SDL_min(d->alpha_run, (Uint32) (n - x));
+        SDL_memset(&dst[x], d->alpha, (size_t) count);
+        d->alpha_run -= (Uint32) count;
+        x += count;
+    }
+    return true;
+}
+
+static inline Uint16 r5z_blend_(const Uint16 src, const Uint16 dst, const int alpha) {
+    // Per channel in 565 units; 6-bit green keeps its extra precision
+    const int r = ((src >> 11) * alpha + (dst >> 11) * (255 - alpha)) / 255;
+    const int g = (((src >> 5) & 0x3F) * alpha + ((dst >> 5) & 0x3F) * (255 - alpha)) / 255;
+    const int b = ((src & 0x1F) * alpha + (dst & 0x1F) * (255 - alpha)) / 255;
+    return (Uint16) ((r << 11) | (g << 5) | b);
+}
+
+// Decode the image onto `framebuffer` (fb_width x fb_height, tightly packed) with its top-left corner at
+// (dest_x, dest_y), alpha-blended if the image has an alpha plane, touching only pixels inside `clip` (NULL: the
+// whole framebuffer). `opacity` (255: none) fades the whole image. Rows that land fully inside an opaque blit
+// decode in place; the rest go through one row of scratch.
+static inline bool r5z_blit_clipped(
+    Uint8 const *data, const size_t size, Uint16 *framebuffer, int fb_width, int fb_height, int dest_x, int dest_y,
+    SDL_Rect const *clip, const Uint8 opacity
+) {
+    int width, height;
+    if (!r5z_info(data, size, &width, &height)) {
+        return false;
+    }
+    const Uint32 alpha_offset = r5z_u32_(&data[8]);
+    if (alpha_offset != 0 && (alpha_offset < R5Z_HEADER_SIZE || alpha_offset > size)) {
+        return false;
+    }
+
+    r5z_decoder_t d = {0};
+    d.pos = &data[R5Z_HEADER_SIZE];
+    d.end = alpha_offset ? &data[alpha_offset] : &data[size];
+    d.alpha_pos = d.end;
+    d.alpha_end = &data[size];
+    const bool opaque = !alpha_offset && opacity == 255;
+
+    Uint16 scratch[R5Z_MAX_WIDTH];
+    Uint8 alpha[R5Z_MAX_WIDTH];
+    SDL_Rect bounds = {0, 0, fb_width, fb_height};
+    if (clip && !SDL_GetRectIntersection(&bounds, clip, &bounds)) {
+        return true;
+    }
+    const int x0 = SDL_max(0, bounds.x - dest_x);
+    const int x1 = SDL_min(width, bounds.x + bounds.w - dest_x);
+    for (int y = 0; y < height; y++) {
+        const int fy = dest_y + y;
+        if (fy >= bounds.y + bounds.h) {
+            break;
+        }
+        const bool visible = fy >= bounds.y && x0 < x1;
+        Uint16 *row = visible ? &framebuffer[fy * fb_width] : NULL;
+        if (visible && opaque && x0 == 0 && x1 == width) {
+            if (!r5z_decode_pixels_(&d, &row[dest_x], width)) {
+                return false;
+            }
+            continue;
+        }
+        if (!r5z_decode_pixels_(&d, scratch, width) || (alpha_offset && !r5z_decode_alpha_(&d, alpha, width))) {
+            return false;
+        }
+        if (!visible) {
+            continue;
+        }
+        if (opaque) {
+            px_copy_u16(&row[dest_x + x0], &scratch[x0], x1 - x0);
+            continue;
+        }
+        for (int x = x0; x < x1; x++) {
+            Uint16 *px = &row[dest_x + x];
+            const int a = ((alpha_offset ? alpha[x] : 255) * opacity + 127) / 255;
+            if (a == 255) {
+                *px = scratch[x];
+            } else if (a != 0) {
+                *px = r5z_blend_(scratch[x], *px, a);
+            }
+        }
+    }
+    return true;
+}
+
+static inline bool r5z_blit(
+    Uint8 const *data, const size_t size, Uint16 *framebuffer, int fb_width, int fb_height, int dest_x, int dest_y
+) {
+    return r5z_blit_clipped(data, size, framebuffer, fb_width, fb_height, dest_x, dest_y, NULL, 255);
+}
@@ -0,0 +1,239 @@
+//
+// Input recording and deterministic replay for the SDL callback apps.
+//
+//     app --record-events session.rec          record every input event and iteration
+//     app --replay session.rec [--fast]        play it back headless and report frame times
+//         [--timings frames.csv]               ...and write every frame time for comparing builds
+//
+// The app clock (replay_ticks) only moves at the start of each SDL_AppIterate, and a recording logs that clock for
+// every iteration as well as every event between iterations. Playback delivers each event before the same iteration
+// it preceded while recording and replays the recorded clock, so the app sees exactly the same sequence of events and
+// times however fast it runs. Without --fast playback waits for the wall clock to catch up with each iteration;
+// with --fast it runs them back to back. The SDL_rand seed is stored in the recording too, so game state comes out
+// identical. Playback runs on the "offscreen" video driver and ignores live input.
+//
+// Apps must use replay_ticks() instead of SDL_GetTicks() for anything that drives their logic.
+//
+// File format, little endian: "SDLREC2\0", Uint64 seed, then 16-byte records {Uint32 ms, type, a, b}: an event
+// (type is its SDL event type) or the start of an iteration (type REPLAY_ITERATION), ms relative to the start.
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#define REPLAY_ITERATION  0u // record type of an iteration start; SDL_EVENT_FIRST, never a real event
+#define REPLAY_MAX_FRAMES 65536
+
+typedef enum { REPLAY_OFF, REPLAY_RECORDING, REPLAY_PLAYING } replay_mode_t;
+
+static struct {
+    replay_mode_t mode;
+    bool fast;
+    bool feeding; // SDL_AppEvent is being called by replay_pump
+    SDL_IOStream *io;
+    Uint64 base_ms;
+    Uint64 clock_ms; // what replay_ticks() returns, latched at the start of each iteration
+    // Playback: the next record, read ahead
+    bool have_next;
+    Uint32 next[4];
+    // Frame times
+    char const *timings_path;
+    float *frame_ms;
+    int num_frames;
+    Uint64 frame_start_ns;
+} replay_;
+
+static inline Uint64 replay_ticks(void) {
+    if (replay_.mode == REPLAY_OFF) {
+        return SDL_GetTicks();
+    }
+    return replay_.clock_ms;
+}
+
+static inline bool replay_read_next_(void) {
+    replay_.have_next = SDL_ReadU32LE(replay_.io, &replay_.next[0]) && SDL_ReadU32LE(replay_.io, &replay_.next[1]) &&
+                        SDL_ReadU32LE(replay_.io, &replay_.next[2]) && SDL_ReadU32LE(replay_.io, &replay_.next[3]);
+    return replay_.have_next;
+}
+
+static inline void replay_write_(const Uint32 type, const Uint32 a, const Uint32 b) {
+    SDL_WriteU32LE(replay_.io, (Uint32) (replay_.clock_ms - replay_.base_ms));
+    SDL_WriteU32LE(replay_.io, type);
+    SDL_WriteU32LE(replay_.io, a);
+    SDL_WriteU32LE(replay_.io, b);
+}
+
+// Handles the replay flags; call before SDL_Init. Returns false if a recording couldn't be opened.
+static inline bool replay_parse_args(int argc, char *argv[]) {
+    char const *record_path = NULL;
+    char const *replay_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--record-events") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (SDL_strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (SDL_strcmp(argv[i], "--fast") == 0) {
+            replay_.fast = true;
+        } else if (SDL_strcmp(argv[i], "--timings") == 0 && i + 1 < argc) {
+            replay_.timings_path = argv[++i];
+        }
+    }
+
+    if (replay_path) {
+        replay_.io = SDL_IOFromFile(replay_path, "rb");
+        char magic[8];
+        Uint64 seed = 0;
+        if (!replay_.io || SDL_ReadIO(replay_.io, magic, sizeof(magic)) != sizeof(magic) ||
+            SDL_memcmp(magic, "SDLREC2", 8) != 0 || !SDL_ReadU64LE(replay_.io, &seed)) {
+            SDL_Log("replay: %s is not a recording: %s", replay_path, SDL_GetError());
+            return false;
+        }
+        SDL_srand(seed);
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        replay_.frame_ms = (float *) SDL_malloc(REPLAY_MAX_FRAMES * sizeof(float));
+        replay_.mode = REPLAY_PLAYING;
+        replay_read_next_();
+        SDL_Log("replay: playing %s%s", replay_path, replay_.fast ? " (fast)" : "");
+    } else if (record_path) {
+        replay_.io = SDL_IOFromFile(record_path, "wb");
+        const Uint64 seed = SDL_GetPerformanceCounter();
+        if (!replay_.io || SDL_WriteIO(replay_.io, "SDLREC2", 8) != 8 || !SDL_WriteU64LE(replay_.io, seed)) {
+            SDL_Log("replay: could not create %s: %s", record_path, SDL_GetError());
+            return false;
+        }
+        SDL_srand(seed);
+        replay_.mode = REPLAY_RECORDING;
+        SDL_Log("replay: recording to %s", record_path);
+    }
+    replay_.base_ms = SDL_GetTicks();
+    replay_.clock_ms = replay_.base_ms;
+    return true;
+}
+
+// Call for every event SDL_AppEvent receives. While playing back, returns true for live input that must be ignored.
+static inline bool replay_filter_event(SDL_Event const *event) {
+    Uint32 a = 0;
+    Uint32 b = 0;
+    switch (event->type) {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            a = event->key.scancode;
+            b = event->key.mod | (event->key.repeat ? 0x10000u : 0);
+            break;
+        case SDL_EVENT_JOYSTICK_HAT_MOTION:
+            a = event->jhat.hat;
+            b = event->jhat.value;
+            break;
+        case SDL_EVENT_QUIT:
+            break;
+        default:
+            return false; // not input; nothing to record or block
+    }
+    if (replay_.mode == REPLAY_PLAYING) {
+        return !replay_.feeding && event->type != SDL_EVENT_QUIT;
+    }
+    if (replay_.mode == REPLAY_RECORDING) {
+        replay_write_(event->type, a, b);
+    }
+    return false;
+}
+
+// Call at the start of SDL_AppIterate, before anything reads replay_ticks(). Moves the app clock to this iteration;
+// while playing, first delivers the events recorded before it to `on_event`.
+// Returns SDL_APP_SUCCESS once every recorded iteration has been played.
+static inline SDL_AppResult replay_pump(void *appstate, SDL_AppEvent_func on_event) {
+    if (replay_.mode == REPLAY_RECORDING) {
+        replay_.clock_ms = SDL_GetTicks();
+        replay_write_(REPLAY_ITERATION, 0, 0);
+        return SDL_APP_CONTINUE;
+    }
+    if (replay_.mode != REPLAY_PLAYING) {
+        return SDL_APP_CONTINUE;
+    }
+
+    // Events still see the previous iteration's clock, as they did while recording
+    while (replay_.have_next && replay_.next[1] != REPLAY_ITERATION) {
+        SDL_Event event;
+        SDL_zero(event);
+        event.type = replay_.next[1];
+        event.common.timestamp = replay_.clock_ms * SDL_NS_PER_MS;
+        if (event.type == SDL_EVENT_KEY_DOWN || event.type == SDL_EVENT_KEY_UP) {
+            event.key.scancode = (SDL_Scancode) replay_.next[2];
+            event.key.mod = (SDL_Keymod) (replay_.next[3] & 0xFFFF);
+            event.key.repeat = (replay_.next[3] & 0x10000u) != 0;
+            event.key.down = event.type == SDL_EVENT_KEY_DOWN;
+            event.key.key = SDL_GetKeyFromScancode(event.key.scancode, event.key.mod, false);
+        } else if (event.type == SDL_EVENT_JOYSTICK_HAT_MOTION) {
+            event.jhat.hat = (Uint8) replay_.next[2];
+            event.jhat.value = (Uint8) replay_.next[3];
+        }
+        replay_read_next_();
+
+        replay_.feeding = true;
+        const SDL_AppResult result = on_event(appstate, &event);
+        replay_.feeding = false;
+        if (result != SDL_APP_CONTINUE) {
+            return result;
+        }
+    }
+    if (!replay_.have_next) {
+        return SDL_APP_SUCCESS;
+    }
+
+    replay_.clock_ms = replay_.base_ms + replay_.next[0];
+    replay_read_next_();
+    if (!replay_.fast) {
+        const Uint64 now = SDL_GetTicks();
+        if (now < replay_.clock_ms) {
+            SDL_Delay((Uint32) (replay_.clock_ms - now));
+        }
+    }
+    replay_.frame_start_ns = SDL_GetTicksNS();
+    return SDL_APP_CONTINUE;
+}
+
+// Call at the end of SDL_AppIterate.
+static inline void replay_frame_end(void) {
+    if (replay_.mode == REPLAY_PLAYING && replay_.frame_ms && replay_.num_frames < REPLAY_MAX_FRAMES) {
+        replay_.frame_ms[replay_.num_frames++] = (float) (SDL_GetTicksNS() - replay_.frame_start_ns) / SDL_NS_PER_MS;
+    }
+}
+
+static int SDLCALL replay_compare_float_(void const *a, void const *b) {
+    const float fa = *(float const *) a;
+    const float fb = *(float const *) b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Call from SDL_AppQuit: closes the recording, or prints (and optionally writes) the frame time distribution.
+static inline void replay_close(void) {
+    if (replay_.mode == REPLAY_PLAYING && replay_.num_frames > 0) {
+        const int n = replay_.num_frames;
+        if (replay_.timings_path) {
+            SDL_IOStream *csv = SDL_IOFromFile(replay_.timings_path, "w");
+            if (csv) {
+                SDL_IOprintf(csv, "frame,ms\n");
+                for (int i = 0; i < n; i++) {
+                    SDL_IOprintf(csv, "%d,%.4f\n", i, replay_.frame_ms[i]);
+                }
+                SDL_CloseIO(csv);
+            }
+        }
+        double total = 0.0;
+        for (int i = 0; i < n; i++) {
+            total += replay_.frame_ms[i];
+        }
+        SDL_qsort(replay_.frame_ms, n, sizeof(float), replay_compare_float_);
+        SDL_Log("replay: %d frames, mean %.3f ms, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f",
+                n, total / n, replay_.frame_ms[n / 2], replay_.frame_ms[n * 9 / 10], replay_.frame_ms[n * 99 / 100],
+                replay_.frame_ms[n - 1]);
+    }
+    if (replay_.io) {
+        SDL_CloseIO(replay_.io);
+        replay_.io = NULL;
+    }
+    SDL_free(replay_.frame_ms);
+    replay_.frame_ms = NULL;
+    replay_.mode = REPLAY_OFF;
+}
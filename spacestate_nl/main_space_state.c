@@ -15,6 +15,12 @@
 #endif
 
 #include "font.h"
+#include "pixfmt.h" // RGB565 conversions for the compositor framebuffer
+#include "trace.h"
+#include "alloc_stats.h"
+#include "watchdog.h"
+#include "timers.h"
+#include "history.h"
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 
@@ -51,81 +57,694 @@
 #include <time.h>
 #include <unistd.h>
 
-#define RGB565(r, g, b)           ((((r) & 0x1F) << 11) | (((g) & 0x3F) << 5) | ((b) & 0x1F))
-#define RGB888_TO_RGB565(r, g, b) RGB565(((r) * 31 + 127) / 255, ((g) * 63 + 127) / 255, ((b) * 31 + 127) / 255)
 
-#define BACKGROUND_IMAGE           "APPS:[SPACESTATE_NL]BACKGROUND.PNG"
-#define PIN_GREEN                  "APPS:[SPACESTATE_NL]PIN_GREEN.PNG"
-#define PIN_RED                    "APPS:[SPACESTATE_NL]PIN_RED.PNG"
+// Built-in art is embedded as R5Z (r5z.h, generated with tools/r5zenc). A PNG with one of these names in
+// APPS:[SPACESTATE_NL] replaces the built-in image.
+#define BACKGROUND_IMAGE           "APPS:[SPACESTATE_NL]MAP.PNG"
+#define PIN_GREEN                  "APPS:[SPACESTATE_NL]PIN_OPEN.PNG"
+#define PIN_RED                    "APPS:[SPACESTATE_NL]PIN_CLOSED.PNG"
 
-#include "background.h"
-#include "pin_green.h"
-#include "pin_red.h"
+// Snapshot of every space's last known state, with the HTTP validators it was parsed from: shown (as stale) right
+// at startup, and lets unchanged documents answer 304 instead of being downloaded again
+#define SPACE_CACHE_FILE           "APPS:[SPACESTATE_NL]CACHE.TXT"
+#define SNAPSHOT_MAX_AGE_S         (7 * 24 * 60 * 60) // older states aren't worth showing
+#define STALE_PIN_OPACITY          110
+
+#include "r5z.h"
+#include "tiles.h"
+#include "background_r5z.h"
+#include "pin_green_r5z.h"
+#include "pin_red_r5z.h"
 
 int render_png_to_framebuffer(
     uint16_t *framebuffer, int fb_width, int fb_height, char const *filename, int dest_x, int dest_y
 );
 int stbi_info(char const *filename, int *x, int *y, int *comp);
-int render_png_with_alpha_scaled(
-    uint16_t *framebuffer, int fb_width, int fb_height, char const *filename, int dest_x, int dest_y, int scale_factor
-);
+
+#include "png_stream.h"
+
+// Replacement PNGs are decoded with png_stream.h a scanline at a time. The background goes straight into the RGB565
+// framebuffer (the SDK's render_png_to_framebuffer, a full RGBA decode through stb_image, is only used for files
+// png_stream.h can't handle); pins are decoded once into memory and blitted from there.
+typedef struct {
+    uint16_t *framebuffer;
+    int fb_width;
+    int fb_height;
+    int dest_x;
+    int dest_y;
+    int scale;
+    bool blend;
+    Uint8 opacity; // applied on top of the image's own alpha when blending
+    SDL_Rect clip; // only pixels in here are written
+} png_blit_t;
+
+#ifdef ENABLE_PNG_DITHER
+// 4x4 ordered dither: spreads the RGB888 -> RGB565 rounding error so gradients don't band
+static const uint8_t png_bayer_[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+static inline uint8_t png_dither_(const uint8_t value, const int threshold) {
+    return (uint8_t) SDL_min(255, value + threshold);
+}
+#endif
+
+static void png_blit_row_(void *userdata, int y, Uint8 const *rgba, int width) {
+    png_blit_t const *blit = (png_blit_t const *) userdata;
+    for (int sy = 0; sy < blit->scale; sy++) {
+        const int fy = blit->dest_y + y * blit->scale + sy;
+        if (fy < blit->clip.y || fy >= blit->clip.y + blit->clip.h) {
+            continue;
+        }
+        uint16_t *row = &blit->framebuffer[fy * blit->fb_width];
+        for (int x = 0; x < width; x++) {
+            Uint8 const *px = &rgba[x * 4];
+            const int alpha = blit->blend ? (px[3] * blit->opacity + 127) / 255 : 255;
+            if (alpha == 0) {
+                continue;
+            }
+            for (int sx = 0; sx < blit->scale; sx++) {
+                const int fx = blit->dest_x + x * blit->scale + sx;
+                if (fx < blit->clip.x || fx >= blit->clip.x + blit->clip.w) {
+                    continue;
+                }
+                uint8_t r = px[0];
+                uint8_t g = px[1];
+                uint8_t b = px[2];
+                if (alpha != 255) {
+                    // Blend in RGB888 against the expanded framebuffer pixel
+                    const uint16_t under = row[fx];
+                    const int ur = ((under >> 8) & 0xF8) | (under >> 13);
+                    const int ug = ((under >> 3) & 0xFC) | ((under >> 9) & 0x03);
+                    const int ub = ((under << 3) & 0xF8) | ((under >> 2) & 0x07);
+                    r = (uint8_t) ((r * alpha + ur * (255 - alpha)) / 255);
+                    g = (uint8_t) ((g * alpha + ug * (255 - alpha)) / 255);
+                    b = (uint8_t) ((b * alpha + ub * (255 - alpha)) / 255);
+                }
+#ifdef ENABLE_PNG_DITHER
+                const int threshold = png_bayer_[fy & 3][fx & 3];
+                r = png_dither_(r, threshold >> 1);
+                g = png_dither_(g, threshold >> 2);
+                b = png_dither_(b, threshold >> 1);
+#endif
+                row[fx] = px_rgb565_from_rgb(r, g, b);
+            }
+        }
+    }
+}
+
+// Set blit->clip to the framebuffer cut down to `clip` (NULL: all of it). False if nothing is left to draw.
+static bool png_blit_clip_(png_blit_t *blit, SDL_Rect const *clip) {
+    const SDL_Rect bounds = {0, 0, blit->fb_width, blit->fb_height};
+    blit->clip = bounds;
+    return !clip || SDL_GetRectIntersection(&bounds, clip, &blit->clip);
+}
+
+// Stream a PNG file onto the framebuffer, with inflate on a worker thread: only worth it for the background
+static png_result_t png_blit_(png_blit_t *blit, char const *filename, SDL_Rect const *clip) {
+    if (!png_blit_clip_(blit, clip)) {
+        return PNG_OK;
+    }
+    SDL_IOStream *io = SDL_IOFromFile(filename, "rb");
+    if (!io) {
+        return PNG_ERR_IO;
+    }
+    ALLOC_TAG_PUSH("png");
+    const png_result_t result = png_stream_decode(io, png_blit_row_, blit, true);
+    ALLOC_TAG_POP();
+    SDL_CloseIO(io);
+    return result;
+}
+
+static void draw_png(
+    uint16_t *framebuffer, int fb_width, int fb_height, char const *filename, int dest_x, int dest_y,
+    SDL_Rect const *clip
+) {
+    png_blit_t blit = {
+        .framebuffer = framebuffer, .fb_width = fb_width, .fb_height = fb_height, .dest_x = dest_x, .dest_y = dest_y,
+        .scale = 1, .opacity = 255,
+    };
+    const png_result_t result = png_blit_(&blit, filename, clip);
+    if (result == PNG_ERR_UNSUPPORTED || result == PNG_ERR_FORMAT) {
+        render_png_to_framebuffer(framebuffer, fb_width, fb_height, filename, dest_x, dest_y);
+    } else if (result != PNG_OK) {
+        printf("Space State NL - could not decode %s (%d)\n", filename, result);
+    }
+}
+
+// Alpha-blend an RGBA8888 image held in memory, `width` pixels per row
+static void draw_rgba(
+    uint16_t *framebuffer, int fb_width, int fb_height, Uint8 const *rgba, int width, int height, int dest_x,
+    int dest_y, SDL_Rect const *clip, Uint8 opacity
+) {
+    png_blit_t blit = {
+        .framebuffer = framebuffer, .fb_width = fb_width, .fb_height = fb_height, .dest_x = dest_x, .dest_y = dest_y,
+        .scale = 1, .blend = true, .opacity = opacity,
+    };
+    if (!png_blit_clip_(&blit, clip)) {
+        return;
+    }
+    const int first = SDL_max(0, blit.clip.y - dest_y);
+    const int last = SDL_min(height, blit.clip.y + blit.clip.h - dest_y);
+    for (int y = first; y < last; y++) {
+        png_blit_row_(&blit, y, &rgba[(size_t) y * width * 4], width);
+    }
+}
+
+static void png_store_row_(void *userdata, int y, Uint8 const *rgba, int width) {
+    Uint8 *image = (Uint8 *) userdata;
+    SDL_memcpy(&image[(size_t) y * width * 4], rgba, (size_t) width * 4);
+}
+
+typedef enum {
+    ASSET_BACKGROUND,
+    ASSET_PIN_GREEN,
+    ASSET_PIN_RED,
+    ASSET_COUNT
+} asset_e;
+
+typedef struct {
+    char const *override_path;
+    unsigned char const *r5z;
+    unsigned int r5z_len;
+    bool overridden;
+    int width;
+    int height;
+    Uint8 *rgba; // decoded replacement PNG, RGBA8888 (all but the background)
+} asset_t;
+
+static asset_t g_assets[ASSET_COUNT] = {
+    [ASSET_BACKGROUND] = { BACKGROUND_IMAGE, background_r5z, sizeof(background_r5z) },
+    [ASSET_PIN_GREEN] = { PIN_GREEN, pin_green_r5z, sizeof(pin_green_r5z) },
+    [ASSET_PIN_RED] = { PIN_RED, pin_red_r5z, sizeof(pin_red_r5z) },
+};
+
+// Decode a replacement PNG into asset->rgba. The background is drawn once and streamed instead.
+static bool load_asset_pixels_(asset_t *asset, SDL_IOStream *io) {
+    ALLOC_TAG_PUSH("assets");
+    asset->rgba = alloc_stats_malloc((size_t) asset->width * asset->height * 4);
+    ALLOC_TAG_POP();
+    if (!asset->rgba || SDL_SeekIO(io, 0, SDL_IO_SEEK_SET) < 0 ||
+        png_stream_decode(io, png_store_row_, asset->rgba, false) != PNG_OK) {
+        alloc_stats_free(asset->rgba);
+        asset->rgba = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Look for replacement PNGs, decode the small ones and read every asset's size once, so drawing an asset never
+// touches the filesystem after startup (except a replaced background, which is only drawn once)
+static void load_assets(void) {
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        asset_t *asset = &g_assets[i];
+        SDL_IOStream *io = SDL_IOFromFile(asset->override_path, "rb");
+        if (io) {
+            asset->overridden = png_stream_info(io, &asset->width, &asset->height);
+            if (asset->overridden && i != ASSET_BACKGROUND && !load_asset_pixels_(asset, io)) {
+                printf("Space State NL - could not decode %s, using the built-in image\n", asset->override_path);
+                asset->overridden = false;
+            }
+            SDL_CloseIO(io);
+        }
+        if (asset->overridden) {
+            printf("Space State NL - using %s\n", asset->override_path);
+        } else {
+            r5z_info(asset->r5z, asset->r5z_len, &asset->width, &asset->height);
+        }
+    }
+}
+
+static void assets_destroy(void) {
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        alloc_stats_free(g_assets[i].rgba);
+        g_assets[i].rgba = NULL;
+    }
+}
+
+// Draw an asset with its top-left corner at (dest_x, dest_y), only touching pixels inside `clip` (NULL: anywhere),
+// faded to `opacity` (255: as is)
+static void draw_asset(
+    asset_e id, uint16_t *framebuffer, int fb_width, int fb_height, int dest_x, int dest_y, SDL_Rect const *clip,
+    Uint8 opacity
+) {
+    asset_t const *asset = &g_assets[id];
+    if (asset->overridden) {
+        if (asset->rgba) {
+            draw_rgba(
+                framebuffer, fb_width, fb_height, asset->rgba, asset->width, asset->height, dest_x, dest_y, clip,
+                opacity
+            );
+        } else {
+            draw_png(framebuffer, fb_width, fb_height, asset->override_path, dest_x, dest_y, clip);
+        }
+    } else if (!r5z_blit_clipped(
+                   asset->r5z, asset->r5z_len, framebuffer, fb_width, fb_height, dest_x, dest_y, clip, opacity
+               )) {
+        printf("Space State NL - built-in image %d is corrupt\n", id);
+    }
+}
 
 // Data van 1 hacker space
+typedef enum {
+    PLACED_NONE,     // no coordinates yet, waiting for the space's SpaceAPI document
+    PLACED_CONFIG,   // built-in pin position, or lat/lon from SPACES_FILE
+    PLACED_DOCUMENT, // location.lat/lon of its SpaceAPI document (kept in the snapshot)
+} space_placed_e;
+
 typedef struct {
-    char* display_name;
-    const char* url;
-    const int x;
-    const int y;
+    char *display_name;
+    char *url;           // empty: no SpaceAPI endpoint
+    int x;               // pin position on the map
+    int y;
+    double lat;
+    double lon;
+    space_placed_e placed;
+    bool on_map;         // placed inside the map: gets a pin and is polled
+    int pin;             // sprite id, -1 if none
+    int history;         // track in g_history, -1 if none
+    bool counted_open;   // currently counted in g_space_state.open_count
     bool is_open;
-    uint32_t last_checked;
+    Uint64 last_checked; // SDL_GetTicks() of the last fetch, 0 if never
+    // Polling schedule, see space_next_poll_ms()
+    bool known;          // is_open came from a successful fetch, now or in an earlier run (see confirmed_at)
+    bool fresh;          // is_open was confirmed by a fetch since startup
+    Sint64 confirmed_at; // wall clock (Unix seconds) of the last successful fetch, 0 if never
+    Uint32 interval_ms;  // current interval while the space answers
+    int failures;        // consecutive failed fetches
+    // Conditional requests: validators of the document is_open was parsed from (empty: none)
+    char etag[64];
+    char last_modified[40];
 } hacker_space_t;
 
-// Enum van Nederlandse hacker spaces
-typedef enum {
-    ackspace, //0
-    awesomespace,
-    bitlair,
-    hack42,
-    hackalot,
-    hs_drenthe,
-    hs_nijmegen,
-    nurdspace,
-    pixelbar,
-    randomdata,
-    revspace,
-    space_leiden,
-    tdvenlo,
-    techinc,
-    tkkrlab,
-    COUNT
-} hacker_spaces_e;
-
-#define NUM_HACKER_SPACES 15
+// Spaces that answer are polled every SPACE_POLL_MIN_MS right after a change, stretching towards SPACE_POLL_MAX_MS
+// while their state stays the same. Failures back off exponentially from SPACE_RETRY_MS; after
+// SPACE_BREAKER_FAILURES in a row the circuit opens and only one probe per SPACE_BREAKER_MS goes out.
+#define SPACE_POLL_MIN_MS      (30 * 1000)
+#define SPACE_POLL_MAX_MS      (5 * 60 * 1000)
+#define SPACE_RETRY_MS         (15 * 1000)
+#define SPACE_RETRY_MAX_MS     (10 * 60 * 1000)
+#define SPACE_BREAKER_FAILURES 5
+#define SPACE_BREAKER_MS       (30 * 60 * 1000)
+#define SPACE_POLL_STAGGER_MS  250
+#define SPACE_CONNECT_TIMEOUT_MS 3000
+#define SPACE_TIMEOUT_MS         8000
+#define SPACE_CACHE_SAVE_MS      (2 * 60 * 1000) // validator changes are batched up before touching flash
+#define SPACE_BODY_MAX           (32 * 1024)     // SpaceAPI documents are a few KB; a bigger body fails the fetch
+#define SPACE_CACHE_CONFIRM_S    (60 * 60)       // a fetch that only moves confirmed_at rewrites the file this rarely
+
+// Timer ids: these, then one per space (TIMER_SPACES + index)
+#define TIMER_SAVE_CACHE 0
+#define TIMER_WIFI       1
+#define TIMER_PREFETCH   2
+#define TIMER_HISTORY    3
+#define TIMER_SPACES     4
+#define IDLE_WAIT_MAX_MS       1000 // longest single sleep in window_event_poll
+
+//
+// Registry: spaces come from SPACES_FILE ("name<TAB>url[<TAB>lat<TAB>lon]" per line, # for comments) and/or a saved
+// SpaceAPI directory (DIRECTORY_FILE, {"name": "url", ...}); without either, from the built-in list below. Spaces
+// without coordinates are placed once their own SpaceAPI document says where they are. Name and URL lookups go
+// through open-addressed hash indexes, so loading and matching stay linear with hundreds of spaces.
+//
+
+#define SPACES_FILE    "APPS:[SPACESTATE_NL]SPACES.TXT"
+#define DIRECTORY_FILE "APPS:[SPACESTATE_NL]DIRECTORY.JSON"
+
+// Linear lat/lon fit of background.png around the Netherlands, giving the pin's top-left corner
+#define MAP_WIDTH     720
+#define MAP_HEIGHT    720
+#define MAP_X0        (-257.5)
+#define MAP_X_PER_LON 114.3
+#define MAP_Y0        345.0
+#define MAP_LAT0      52.07
+#define MAP_Y_PER_LAT (-176.5)
 
 typedef struct {
-    hacker_space_t hackerspaces[NUM_HACKER_SPACES/*COUNT*/];
+    hacker_space_t *spaces;
+    int count;
+    int capacity;
+    int *by_name;   // hash index into spaces, -1: empty slot
+    int *by_url;
+    int index_size; // slots per index, a power of two at least twice count
+    int mapped;     // spaces placed on the map
+    int open_count; // of those, known to be open
 } hacker_spaces_t;
 
-static hacker_spaces_t g_space_state = {
-    .hackerspaces = {
-        [ackspace] = { "ACKspace", "https://ackspace.nl/spaceAPI", 445, 555, false, 0 },
-        [awesomespace] = { "AwesomeSpace", "https://state.awesomespace.nl", 345, 319, false, 0 },
-        [bitlair] = { "Bitlair", "https://bitlair.nl/statejson.php", 378, 343, false, 0 },
-        [hack42] = { "Hack42", "https://hack42.nl/spacestate/json.php", 438, 348, false, 0 },
-        [hackalot] = { "Hackalot", "https://hackalot.nl/statejson", 390, 443, false, 0 },
-        [hs_drenthe] = { "Hackerspace Drenthe", "https://mqtt.hackerspace-drenthe.nl/spaceapi", 527, 209, false, 0 },
-        [hs_nijmegen] = { "Hackerspace Nijmegen", "https://state.hackerspacenijmegen.nl/state.json", 416, 380, false, 0 },
-        [nurdspace] = { "NURDSpace", "https://space.nurdspace.nl/spaceapi/status.json", 385, 385, false, 0 },
-        [pixelbar] = { "Pixelbar", "https://spaceapi.pixelbar.nl/", 272, 368, false, 0 },
-        [randomdata] = { "RandomData", "", 326, 353, false, 0 },
-        [revspace] = { "RevSpace", "https://revspace.nl/status/status.php", 234, 345, false, 0 },
-        [space_leiden] = { "Space Leiden", "https://portal.spaceleiden.nl/api/public/status.json", 260, 320, false, 0 },
-        [tdvenlo] = { "TDvenlo", "https://spaceapi.tdvenlo.nl/spaceapi.json", 458, 470, false, 0},
-        [techinc] = { "TechInc", "", 290, 270, false, 0 },
-        [tkkrlab] = { "TkkrLab", "https://spaceapi.tkkrlab.nl", 530, 310, false, 0}
-    }
+static hacker_spaces_t g_space_state = {0};
+
+// Open/closed history of every space with an endpoint (history.h), keyed by the hash of its URL. Observations are
+// appended to HISTORY_FILE in batches.
+#define HISTORY_FILE     "APPS:[SPACESTATE_NL]HISTORY.LOG"
+#define HISTORY_FLUSH_MS (15 * 60 * 1000)
+
+static history_t g_history = {0};
+
+// Nederlandse hacker spaces, used when there is no SPACES_FILE or DIRECTORY_FILE; pins hand-placed on the map
+static const struct {
+    char const *name;
+    char const *url;
+    int x;
+    int y;
+} g_builtin_spaces[] = {
+    { "ACKspace", "https://ackspace.nl/spaceAPI", 445, 555 },
+    { "AwesomeSpace", "https://state.awesomespace.nl", 345, 319 },
+    { "Bitlair", "https://bitlair.nl/statejson.php", 378, 343 },
+    { "Hack42", "https://hack42.nl/spacestate/json.php", 438, 348 },
+    { "Hackalot", "https://hackalot.nl/statejson", 390, 443 },
+    { "Hackerspace Drenthe", "https://mqtt.hackerspace-drenthe.nl/spaceapi", 527, 209 },
+    { "Hackerspace Nijmegen", "https://state.hackerspacenijmegen.nl/state.json", 416, 380 },
+    { "NURDSpace", "https://space.nurdspace.nl/spaceapi/status.json", 385, 385 },
+    { "Pixelbar", "https://spaceapi.pixelbar.nl/", 272, 368 },
+    { "RandomData", "", 326, 353 },
+    { "RevSpace", "https://revspace.nl/status/status.php", 234, 345 },
+    { "Space Leiden", "https://portal.spaceleiden.nl/api/public/status.json", 260, 320 },
+    { "TDvenlo", "https://spaceapi.tdvenlo.nl/spaceapi.json", 458, 470 },
+    { "TechInc", "", 290, 270 },
+    { "TkkrLab", "https://spaceapi.tkkrlab.nl", 530, 310 },
 };
 
+static Uint32 space_hash_(char const *key) {
+    Uint32 hash = 2166136261u; // FNV-1a
+    for (; *key; key++) {
+        hash = (hash ^ (Uint8) *key) * 16777619u;
+    }
+    return hash;
+}
+
+static char const *space_key_(hacker_space_t const *space, const bool by_url) {
+    return by_url ? space->url : space->display_name;
+}
+
+static void space_index_insert_(int *index, const int i, const bool by_url) {
+    char const *key = space_key_(&g_space_state.spaces[i], by_url);
+    if (key[0] == '\0') {
+        return;
+    }
+    const Uint32 mask = (Uint32) g_space_state.index_size - 1;
+    Uint32 slot = space_hash_(key) & mask;
+    while (index[slot] >= 0) {
+        slot = (slot + 1) & mask;
+    }
+    index[slot] = i;
+}
+
+static int space_find_(int const *index, char const *key, const bool by_url) {
+    if (g_space_state.index_size == 0 || key[0] == '\0') {
+        return -1;
+    }
+    const Uint32 mask = (Uint32) g_space_state.index_size - 1;
+    for (Uint32 slot = space_hash_(key) & mask; index[slot] >= 0; slot = (slot + 1) & mask) {
+        if (strcmp(space_key_(&g_space_state.spaces[index[slot]], by_url), key) == 0) {
+            return index[slot];
+        }
+    }
+    return -1;
+}
+
+static int space_find_by_name(char const *name) {
+    return space_find_(g_space_state.by_name, name, false);
+}
+
+static int space_find_by_url(char const *url) {
+    return space_find_(g_space_state.by_url, url, true);
+}
+
+static bool spaces_reserve_(const int count) {
+    if (count > g_space_state.capacity) {
+        const int capacity = SDL_max(count, SDL_max(16, g_space_state.capacity * 2));
+        hacker_space_t *spaces = alloc_stats_realloc(g_space_state.spaces, (size_t) capacity * sizeof(*spaces));
+        if (spaces == NULL) {
+            return false;
+        }
+        g_space_state.spaces = spaces;
+        g_space_state.capacity = capacity;
+    }
+    if (count * 2 > g_space_state.index_size) {
+        int size = SDL_max(64, g_space_state.index_size);
+        while (count * 2 > size) {
+            size *= 2;
+        }
+        int *by_name = alloc_stats_malloc((size_t) size * sizeof(int));
+        int *by_url = alloc_stats_malloc((size_t) size * sizeof(int));
+        if (by_name == NULL || by_url == NULL) {
+            alloc_stats_free(by_name);
+            alloc_stats_free(by_url);
+            return false;
+        }
+        alloc_stats_free(g_space_state.by_name);
+        alloc_stats_free(g_space_state.by_url);
+        SDL_memset(by_name, 0xFF, (size_t) size * sizeof(int));
+        SDL_memset(by_url, 0xFF, (size_t) size * sizeof(int));
+        g_space_state.by_name = by_name;
+        g_space_state.by_url = by_url;
+        g_space_state.index_size = size;
+        for (int i = 0; i < g_space_state.count; i++) {
+            space_index_insert_(by_name, i, false);
+            space_index_insert_(by_url, i, true);
+        }
+    }
+    return true;
+}
+
+static char *space_strdup_(char const *text) {
+    const size_t size = strlen(text) + 1;
+    char *copy = alloc_stats_malloc(size);
+    if (copy) {
+        memcpy(copy, text, size);
+    }
+    return copy;
+}
+
+// Keep g_space_state.open_count in step with a space's state
+static void space_sync_counts_(hacker_space_t *space) {
+    const bool open = space->on_map && space->known && space->is_open;
+    g_space_state.open_count += (int) open - (int) space->counted_open;
+    space->counted_open = open;
+}
+
+static void space_place_at(hacker_space_t *space, const int x, const int y, const space_placed_e placed) {
+    const bool on_map = x >= 0 && x < MAP_WIDTH && y >= 0 && y < MAP_HEIGHT;
+    g_space_state.mapped += (int) on_map - (int) space->on_map;
+    space->x = x;
+    space->y = y;
+    space->placed = placed;
+    space->on_map = on_map;
+    space_sync_counts_(space);
+}
+
+static void space_place(hacker_space_t *space, const double lat, const double lon, const space_placed_e placed) {
+    space->lat = lat;
+    space->lon = lon;
+    space_place_at(
+        space, (int) SDL_lround(MAP_X0 + MAP_X_PER_LON * lon),
+        (int) SDL_lround(MAP_Y0 + MAP_Y_PER_LAT * (lat - MAP_LAT0)), placed
+    );
+}
+
+// Add a space, or return the one that already has this name or URL. -1 if out of memory.
+static int space_add(char const *name, char const *url) {
+    int i = space_find_by_name(name);
+    if (i < 0) {
+        i = space_find_by_url(url);
+    }
+    if (i >= 0) {
+        return i;
+    }
+    if (!spaces_reserve_(g_space_state.count + 1)) {
+        return -1;
+    }
+    hacker_space_t *space = &g_space_state.spaces[g_space_state.count];
+    SDL_zerop(space);
+    space->display_name = space_strdup_(name);
+    space->url = space_strdup_(url);
+    if (space->display_name == NULL || space->url == NULL) {
+        alloc_stats_free(space->display_name);
+        alloc_stats_free(space->url);
+        return -1;
+    }
+    space->pin = -1;
+    space->history = -1;
+    i = g_space_state.count++;
+    space_index_insert_(g_space_state.by_name, i, false);
+    space_index_insert_(g_space_state.by_url, i, true);
+    return i;
+}
+
+// Split `line` at tabs into up to `max` fields; returns how many there are
+static int split_tabs(char *line, char **fields, const int max) {
+    line[strcspn(line, "\r\n")] = '\0';
+    int n = 0;
+    fields[n++] = line;
+    while (n < max && (line = strchr(line, '\t')) != NULL) {
+        *line++ = '\0';
+        fields[n++] = line;
+    }
+    return n;
+}
+
+static void load_spaces_file(void) {
+    FILE *f = fopen(SPACES_FILE, "r");
+    if (f == NULL) {
+        return;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char *fields[4];
+        const int n = split_tabs(line, fields, 4);
+        if (fields[0][0] == '#' || fields[0][0] == '\0') {
+            continue;
+        }
+        const int i = space_add(fields[0], n > 1 ? fields[1] : "");
+        if (i >= 0 && n == 4) {
+            const double lat = SDL_strtod(fields[2], NULL);
+            space_place(&g_space_state.spaces[i], lat, SDL_strtod(fields[3], NULL), PLACED_CONFIG);
+        }
+    }
+    fclose(f);
+}
+
+// The four hex digits of a \uXXXX escape at `p`; -1 if they aren't
+static int json_hex4_(char const *p) {
+    int value = 0;
+    for (int i = 0; i < 4; i++) {
+        if (!SDL_isxdigit((unsigned char) p[i])) {
+            return -1;
+        }
+        value = value * 16 + (SDL_isdigit((unsigned char) p[i]) ? p[i] - '0' : (p[i] | 0x20) - 'a' + 10);
+    }
+    return value;
+}
+
+// Copy the JSON string starting at the quote `p` points to into `dst`, decoding its escapes: \uXXXX (and surrogate
+// pairs) to UTF-8, like the rest of the document; anything unknown or malformed is kept as-is. Stops copying at the
+// first character that doesn't fit. Returns the position after the closing quote, NULL if it doesn't end.
+static char const *json_read_string_(char const *p, char *dst, const size_t dst_size) {
+    size_t n = 0;
+    bool full = false;
+    for (p++; *p && *p != '"'; p++) {
+        char decoded[4] = {*p};
+        size_t len = 1;
+        if (*p == '\\' && p[1]) {
+            p++;
+            int code = -1;
+            switch (*p) {
+                case 'b':
+                    decoded[0] = '\b';
+                    break;
+                case 'f':
+                    decoded[0] = '\f';
+                    break;
+                case 'n':
+                    decoded[0] = '\n';
+                    break;
+                case 'r':
+                    decoded[0] = '\r';
+                    break;
+                case 't':
+                    decoded[0] = '\t';
+                    break;
+                case '"':
+                case '\\':
+                case '/':
+                    decoded[0] = *p;
+                    break;
+                case 'u':
+                    code = json_hex4_(p + 1);
+                    if (code >= 0) {
+                        break;
+                    }
+                    SDL_FALLTHROUGH;
+                default:
+                    decoded[0] = '\\';
+                    decoded[1] = *p;
+                    len = 2;
+                    break;
+            }
+            if (code >= 0) {
+                p += 4;
+                const int low = code >= 0xD800 && code < 0xDC00 && p[1] == '\\' && p[2] == 'u' ? json_hex4_(p + 3) : -1;
+                if (low >= 0xDC00 && low < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                } else if (code >= 0xD800 && code < 0xE000) {
+                    code = 0xFFFD; // half a surrogate pair
+                }
+                len = (size_t) (SDL_UCS4ToUTF8((Uint32) code, decoded) - decoded);
+            }
+        }
+        full = full || n + len >= dst_size;
+        if (!full) {
+            SDL_memcpy(&dst[n], decoded, len);
+            n += len;
+        }
+    }
+    dst[n] = '\0';
+    return *p ? p + 1 : NULL;
+}
+
+// A saved https://directory.spaceapi.io/ answer: one flat object mapping space names to their SpaceAPI URLs
+static void load_directory_file(void) {
+    FILE *f = fopen(DIRECTORY_FILE, "rb");
+    if (f == NULL) {
+        return;
+    }
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *json = size > 0 ? alloc_stats_malloc((size_t) size + 1) : NULL;
+    if (json && fread(json, 1, (size_t) size, f) == (size_t) size) {
+        json[size] = '\0';
+        char name[96], url[256];
+        for (char const *p = strchr(json, '"'); p; p = strchr(p, '"')) {
+            if ((p = json_read_string_(p, name, sizeof(name))) == NULL) {
+                break;
+            }
+            p += strspn(p, " \t\r\n");
+            if (*p != ':') {
+                continue;
+            }
+            p += 1 + strspn(p + 1, " \t\r\n");
+            if (*p != '"' || (p = json_read_string_(p, url, sizeof(url))) == NULL) {
+                continue;
+            }
+            space_add(name, url);
+        }
+    }
+    alloc_stats_free(json);
+    fclose(f);
+}
+
+static void load_spaces(void) {
+    ALLOC_TAG_PUSH("spaces");
+    load_spaces_file();
+    load_directory_file();
+    if (g_space_state.count == 0) {
+        for (size_t b = 0; b < SDL_arraysize(g_builtin_spaces); b++) {
+            const int i = space_add(g_builtin_spaces[b].name, g_builtin_spaces[b].url);
+            if (i >= 0) {
+                space_place_at(&g_space_state.spaces[i], g_builtin_spaces[b].x, g_builtin_spaces[b].y, PLACED_CONFIG);
+            }
+        }
+    }
+    ALLOC_TAG_POP();
+    printf("Space State NL - %d spaces, %d on the map\n", g_space_state.count, g_space_state.mapped);
+}
+
+// Polled: has an endpoint, and is on the map or might turn out to be once its document says where it is
+static bool space_wants_poll(hacker_space_t const *space) {
+    return space->url[0] != '\0' && (space->on_map || space->placed == PLACED_NONE);
+}
+
+static void spaces_destroy(void) {
+    for (int i = 0; i < g_space_state.count; i++) {
+        alloc_stats_free(g_space_state.spaces[i].display_name);
+        alloc_stats_free(g_space_state.spaces[i].url);
+    }
+    alloc_stats_free(g_space_state.spaces);
+    alloc_stats_free(g_space_state.by_name);
+    alloc_stats_free(g_space_state.by_url);
+    SDL_zero(g_space_state);
+}
+
 #define ACTIVITY_LOADING 0
 #define ACTIVITY_MAP 1
 #define ACTIVITY_LOADING_NO_IMAGES 2
@@ -141,23 +760,377 @@ typedef struct {
 
 static app_state_t g_app_state = {0};
 
+//
+// Layers: the clean background plus a list of sprites (pins, labels) drawn on top in list order. A sprite that
+// changes restores its old and new bounding boxes from the clean background, re-blends every sprite overlapping
+// them (clipped to the box), and only those boxes are presented. Changed sprites are queued, so a frame where nothing
+// changed costs nothing however many pins there are.
+//
+
+#define LABEL_MAX_TEXT    48
+#define LABEL_PADDING     4
+#define PANEL_CELL_W      12 // one hour
+#define PANEL_CELL_H      10
+#define PANEL_WIDTH       (2 * LABEL_PADDING + 24 * PANEL_CELL_W)
+#define PANEL_HEIGHT      (2 * LABEL_PADDING + 4 * FONT_HEIGHT + 14 * PANEL_CELL_H)
+
+typedef enum {
+    SPRITE_IMAGE,
+    SPRITE_LABEL,
+    SPRITE_HISTORY,
+} sprite_kind_e;
+
+typedef struct {
+    sprite_kind_e kind;
+    asset_e asset;               // SPRITE_IMAGE
+    Uint8 opacity;               // SPRITE_IMAGE
+    char text[LABEL_MAX_TEXT];   // SPRITE_LABEL
+    int space;                   // SPRITE_HISTORY
+    SDL_Rect rect;
+    SDL_Rect drawn;              // where it was last presented, empty if nowhere
+    bool visible;
+    bool dirty;
+} sprite_t;
+
+typedef struct {
+    sprite_t *sprites;
+    int count;
+    int capacity;
+    int *dirty;             // ids of the sprites with `dirty` set
+    int dirty_count;
+    window_rect_t *damage;  // one box per dirty sprite
+} layers_t;
+
+static layers_t g_layers = {0};
+
+static bool layers_init(const int capacity) {
+    g_layers.sprites = alloc_stats_malloc((size_t) capacity * sizeof(sprite_t));
+    g_layers.dirty = alloc_stats_malloc((size_t) capacity * sizeof(int));
+    g_layers.damage = alloc_stats_malloc((size_t) capacity * sizeof(window_rect_t));
+    g_layers.count = 0;
+    g_layers.dirty_count = 0;
+    g_layers.capacity = capacity;
+    return g_layers.sprites && g_layers.dirty && g_layers.damage;
+}
+
+static void layers_destroy(void) {
+    alloc_stats_free(g_layers.sprites);
+    alloc_stats_free(g_layers.dirty);
+    alloc_stats_free(g_layers.damage);
+    SDL_zero(g_layers);
+}
+
+static void sprite_touch_(sprite_t *sprite) {
+    if (!sprite->dirty) {
+        sprite->dirty = true;
+        g_layers.dirty[g_layers.dirty_count++] = (int) (sprite - g_layers.sprites);
+    }
+}
+
+static int sprite_add(sprite_kind_e kind, int x, int y) {
+    SDL_assert(g_layers.count < g_layers.capacity);
+    sprite_t *sprite = &g_layers.sprites[g_layers.count];
+    SDL_zerop(sprite);
+    sprite->kind = kind;
+    sprite->rect.x = x;
+    sprite->rect.y = y;
+    return g_layers.count++;
+}
+
+static void sprite_move(int id, int x, int y) {
+    sprite_t *sprite = &g_layers.sprites[id];
+    if (sprite->rect.x == x && sprite->rect.y == y) {
+        return;
+    }
+    sprite->rect.x = x;
+    sprite->rect.y = y;
+    if (sprite->visible) {
+        sprite_touch_(sprite);
+    }
+}
+
+static void sprite_set_image(int id, asset_e asset, Uint8 opacity) {
+    sprite_t *sprite = &g_layers.sprites[id];
+    if (sprite->visible && sprite->asset == asset && sprite->opacity == opacity) {
+        return;
+    }
+    sprite->asset = asset;
+    sprite->opacity = opacity;
+    sprite->rect.w = g_assets[asset].width;
+    sprite->rect.h = g_assets[asset].height;
+    sprite->visible = true;
+    sprite_touch_(sprite);
+}
+
+static void sprite_set_text(int id, char const *text) {
+    sprite_t *sprite = &g_layers.sprites[id];
+    if (sprite->visible && SDL_strcmp(sprite->text, text) == 0) {
+        return;
+    }
+    SDL_strlcpy(sprite->text, text, sizeof(sprite->text));
+    sprite->rect.w = (int) SDL_strlen(sprite->text) * FONT_WIDTH + 2 * LABEL_PADDING;
+    sprite->rect.h = FONT_HEIGHT + 2 * LABEL_PADDING;
+    sprite->visible = true;
+    sprite_touch_(sprite);
+}
+
+static void sprite_set_history(int id, int space) {
+    sprite_t *sprite = &g_layers.sprites[id];
+    if (sprite->visible && sprite->space == space) {
+        return;
+    }
+    sprite->space = space;
+    sprite->rect.w = PANEL_WIDTH;
+    sprite->rect.h = PANEL_HEIGHT;
+    sprite->visible = true;
+    sprite_touch_(sprite);
+}
+
+static void sprite_hide(int id) {
+    sprite_t *sprite = &g_layers.sprites[id];
+    if (sprite->visible) {
+        sprite->visible = false;
+        sprite_touch_(sprite);
+    }
+}
+
+// Have a visible sprite drawn again, for when what it shows changed
+static void sprite_refresh(int id) {
+    sprite_t *sprite = &g_layers.sprites[id];
+    if (sprite->visible) {
+        sprite_touch_(sprite);
+    }
+}
+
+static void fill_rect(uint16_t *framebuffer, int fb_width, SDL_Rect const *rect, SDL_Rect const *clip, uint16_t color) {
+    SDL_Rect box;
+    if (!SDL_GetRectIntersection(rect, clip, &box)) {
+        return;
+    }
+    for (int y = box.y; y < box.y + box.h; y++) {
+        px_fill(&framebuffer[y * fb_width + box.x], box.w, color);
+    }
+}
+
+// Draw `text` with its top-left corner at (x, y), touching only pixels inside `clip`
+static void draw_text(
+    uint16_t *framebuffer, int fb_width, int x, int y, char const *text, SDL_Rect const *clip, uint16_t color
+) {
+    for (int i = 0; text[i]; i++) {
+        const int c = (unsigned char) text[i];
+        const int char_x = x + i * FONT_WIDTH;
+        const int from = SDL_max(0, clip->x - char_x);
+        const int to = SDL_min(FONT_WIDTH, clip->x + clip->w - char_x);
+        if (c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR || from >= to) {
+            continue;
+        }
+        for (int row = SDL_max(0, clip->y - y); row < FONT_HEIGHT && y + row < clip->y + clip->h; row++) {
+            px_glyph_row(
+                &framebuffer[(y + row) * fb_width + char_x], pixel_font[c - FONT_FIRST_CHAR][row], from, to, color
+            );
+        }
+    }
+}
+
+// The next space after `space` (-1: from the start) that has a pin, wrapping around; -1 if none has
+static int next_pinned_space(int space) {
+    for (int n = 1; n <= g_space_state.count; n++) {
+        const int s = (space + n) % g_space_state.count;
+        if (g_space_state.spaces[s].pin >= 0) {
+            return s;
+        }
+    }
+    return -1;
+}
+
+static void draw_label(sprite_t const *sprite, uint16_t *framebuffer, int fb_width, SDL_Rect const *clip) {
+    SDL_Rect box;
+    if (!SDL_GetRectIntersection(&sprite->rect, clip, &box)) {
+        return;
+    }
+    fill_rect(framebuffer, fb_width, &box, &box, px_rgb565(CDE_PANEL_COLOR));
+    draw_text(
+        framebuffer, fb_width, sprite->rect.x + LABEL_PADDING, sprite->rect.y + LABEL_PADDING, sprite->text, &box,
+        px_rgb565(CDE_TEXT_COLOR)
+    );
+}
+
+//
+// History panel: for one space, how often it was open in each hour of a usual week (over the whole history window),
+// and what it actually did over the last seven days. One row per day, both grids line up on the hour.
+//
+
+// Color for a share of open time: red (never) to green (always), grey without data
+static uint16_t open_share_color(int open, int known) {
+    if (known == 0) {
+        return px_rgb565(CDE_PROGRESS_BG);
+    }
+    Uint8 channel[3];
+    for (int i = 0; i < 3; i++) {
+        const int from = (CDE_ERROR_COLOR >> (16 - 8 * i)) & 0xFF;
+        const int to = (CDE_SUCCESS_COLOR >> (16 - 8 * i)) & 0xFF;
+        channel[i] = (Uint8) (from + (to - from) * open / known);
+    }
+    return px_rgb565_from_rgb(channel[0], channel[1], channel[2]);
+}
+
+static void draw_history_panel(sprite_t const *sprite, uint16_t *framebuffer, int fb_width, SDL_Rect const *clip) {
+    SDL_Rect box;
+    if (!SDL_GetRectIntersection(&sprite->rect, clip, &box)) {
+        return;
+    }
+    const uint16_t text = px_rgb565(CDE_TEXT_COLOR);
+    fill_rect(framebuffer, fb_width, &box, &box, px_rgb565(CDE_PANEL_COLOR));
+    hacker_space_t const *space = &g_space_state.spaces[sprite->space];
+    history_track_t const *track = space->history >= 0 ? &g_history.tracks[space->history] : NULL;
+
+    SDL_Time now = 0;
+    SDL_DateTime local = {0};
+    SDL_GetCurrentTime(&now);
+    SDL_TimeToDateTime(now, &local, true);
+    Uint16 known[7 * 24] = {0}, open[7 * 24] = {0};
+    if (track) {
+        history_week_profile(track, local.utc_offset, known, open);
+    }
+
+    const int x = sprite->rect.x + LABEL_PADDING;
+    int y = sprite->rect.y + LABEL_PADDING;
+    char line[LABEL_MAX_TEXT];
+    draw_text(framebuffer, fb_width, x, y, space->display_name, &box, text);
+    y += FONT_HEIGHT;
+    const int hour = local.day_of_week * 24 + local.hour;
+    SDL_snprintf(
+        line, sizeof(line), "%s, usually %s", !space->known ? "Unknown" : space->is_open ? "Open" : "Closed",
+        known[hour] == 0 ? "?" : open[hour] * 2 >= known[hour] ? "open" : "closed"
+    );
+    draw_text(framebuffer, fb_width, x, y, line, &box, text);
+    y += FONT_HEIGHT;
+
+    // Usual week, Monday first
+    draw_text(framebuffer, fb_width, x, y, "Usual week, Mon-Sun", &box, text);
+    y += FONT_HEIGHT;
+    for (int row = 0; row < 7; row++) {
+        const int day = (row + 1) % 7;
+        for (int h = 0; h < 24; h++) {
+            const SDL_Rect cell = {x + h * PANEL_CELL_W, y, PANEL_CELL_W - 1, PANEL_CELL_H - 1};
+            fill_rect(framebuffer, fb_width, &cell, &box, open_share_color(open[day * 24 + h], known[day * 24 + h]));
+        }
+        y += PANEL_CELL_H;
+    }
+
+    // Last seven days, today at the bottom; one half-hour slot per half cell
+    draw_text(framebuffer, fb_width, x, y, "Last 7 days", &box, text);
+    y += FONT_HEIGHT;
+    const Sint64 midnight = now / SDL_NS_PER_SECOND - ((local.hour * 60 + local.minute) * 60 + local.second);
+    for (int row = 0; row < 7; row++) {
+        const Sint64 day_start = midnight - (Sint64) (6 - row) * 86400;
+        const Sint32 first = (Sint32) ((day_start - HISTORY_EPOCH) / HISTORY_SLOT_S);
+        for (int s = 0; s < 48; s++) {
+            const history_state_e state = track ? history_state_at(track, first + s) : HISTORY_UNKNOWN;
+            const SDL_Rect cell = {x + s * PANEL_CELL_W / 2, y, PANEL_CELL_W / 2, PANEL_CELL_H - 1};
+            fill_rect(
+                framebuffer, fb_width, &cell, &box,
+                open_share_color(state == HISTORY_OPEN, state != HISTORY_UNKNOWN)
+            );
+        }
+        y += PANEL_CELL_H;
+    }
+}
+
+// Rebuild one damaged box: clean background, then every visible sprite that overlaps it
+static void layers_repaint(uint16_t *framebuffer, SDL_Rect const *box) {
+    const int fb_width = g_app_state.fb_width;
+    for (int y = box->y; y < box->y + box->h; y++) {
+        const size_t offset = (size_t) y * fb_width + box->x;
+        px_copy(&framebuffer[offset], &g_app_state.clean_background[offset], box->w);
+    }
+    for (int i = 0; i < g_layers.count; i++) {
+        sprite_t const *sprite = &g_layers.sprites[i];
+        if (!sprite->visible || !SDL_HasRectIntersection(&sprite->rect, box)) {
+            continue;
+        }
+        if (sprite->kind == SPRITE_IMAGE) {
+            draw_asset(
+                sprite->asset, framebuffer, fb_width, g_app_state.fb_height, sprite->rect.x, sprite->rect.y, box,
+                sprite->opacity
+            );
+        } else if (sprite->kind == SPRITE_LABEL) {
+            draw_label(sprite, framebuffer, fb_width, box);
+        } else {
+            draw_history_panel(sprite, framebuffer, fb_width, box);
+        }
+    }
+}
+
+// Repaint and present the whole screen, for when the clean background itself changed
+static void layers_redraw(window_handle_t window, uint16_t *framebuffer) {
+    const SDL_Rect screen = {0, 0, g_app_state.fb_width, g_app_state.fb_height};
+    for (int d = 0; d < g_layers.dirty_count; d++) {
+        g_layers.sprites[g_layers.dirty[d]].dirty = false;
+    }
+    g_layers.dirty_count = 0;
+    for (int i = 0; i < g_layers.count; i++) {
+        sprite_t *sprite = &g_layers.sprites[i];
+        sprite->drawn = sprite->visible ? sprite->rect : (SDL_Rect) {0};
+    }
+    layers_repaint(framebuffer, &screen);
+    TRACE_BEGIN("window_present");
+    window_present(window, true, NULL, 0);
+    TRACE_END("window_present");
+}
+
+// Repaint and present whatever changed since the last call. Returns the number of boxes presented.
+static int layers_flush(window_handle_t window, uint16_t *framebuffer) {
+    const SDL_Rect screen = {0, 0, g_app_state.fb_width, g_app_state.fb_height};
+    int count = 0;
+    for (int d = 0; d < g_layers.dirty_count; d++) {
+        sprite_t *sprite = &g_layers.sprites[g_layers.dirty[d]];
+        sprite->dirty = false;
+        SDL_Rect box = sprite->visible ? sprite->rect : sprite->drawn;
+        if (!SDL_RectEmpty(&sprite->drawn)) {
+            SDL_GetRectUnion(&box, &sprite->drawn, &box);
+        }
+        sprite->drawn = sprite->visible ? sprite->rect : (SDL_Rect) {0};
+        if (!SDL_GetRectIntersection(&box, &screen, &box)) {
+            continue;
+        }
+        layers_repaint(framebuffer, &box);
+        g_layers.damage[count++] = (window_rect_t) {box.x, box.y, box.w, box.h};
+    }
+    g_layers.dirty_count = 0;
+    if (count > 0) {
+        TRACE_BEGIN("window_present");
+        window_present(window, true, g_layers.damage, count);
+        TRACE_END("window_present");
+    }
+    return count;
+}
+
 // For cURL response
 typedef struct {
     char *memory;
     size_t size;
+    size_t capacity;
 } MemoryStruct;
 
+// Appends to the body, doubling the buffer as needed; past SPACE_BODY_MAX it returns 0, which makes cURL give up
 static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, MemoryStruct *mem) {
     size_t realsize = size * nmemb;
-    printf("Callback recieved %u bytes\n", realsize);
-
-    char *ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (!ptr) {
-        printf("Not enough memory (realloc returned NULL)\n");
+    if (mem->size + realsize > SPACE_BODY_MAX) {
+        printf("Body larger than %d bytes, giving up\n", SPACE_BODY_MAX);
         return 0;
     }
 
-    mem->memory = ptr;
+    if (mem->size + realsize + 1 > mem->capacity) {
+        const size_t capacity = SDL_min(SDL_max(mem->capacity * 2, mem->size + realsize + 1), SPACE_BODY_MAX + 1);
+        char *ptr = alloc_stats_realloc(mem->memory, capacity);
+        if (!ptr) {
+            printf("Not enough memory (realloc returned NULL)\n");
+            return 0;
+        }
+        mem->memory = ptr;
+        mem->capacity = capacity;
+    }
     memcpy(&(mem->memory[mem->size]), contents, realsize);
     mem->size              += realsize;
     mem->memory[mem->size]  = 0;
@@ -178,12 +1151,70 @@ void remove_whitespace(char *str) {
     *dst = '\0'; // afsluiten
 }
 
-bool get_space_state(const char *space_url) {
+typedef enum {
+    SPACE_FETCH_CLOSED,
+    SPACE_FETCH_OPEN,
+    SPACE_FETCH_ERROR, // no answer, HTTP error or no "open" field
+} space_fetch_e;
+
+static struct {
+    Uint32 fetches;
+    Uint32 not_modified;   // answered 304, nothing transferred or parsed
+    Uint64 body_bytes;
+    bool cache_dirty;      // the snapshot changed since SPACE_CACHE_FILE was written
+    bool confirmed;        // only confirmed_at moved since then: written on exit or after SPACE_CACHE_CONFIRM_S
+    Sint64 cache_saved_at; // wall clock (Unix seconds) SPACE_CACHE_FILE was last read or written
+} g_fetch_stats = {0};
+
+typedef struct {
+    char etag[64];
+    char last_modified[40];
+} HttpValidators;
+
+// Copy the value of header `name` out of `line` ("Name: value\r\n") into `dst`, if it is that header
+static void copy_header_value(char const *line, size_t len, char const *name, char *dst, size_t dst_size) {
+    const size_t name_len = strlen(name);
+    if (len <= name_len + 1 || SDL_strncasecmp(line, name, name_len) != 0 || line[name_len] != ':') {
+        return;
+    }
+    line += name_len + 1;
+    len -= name_len + 1;
+    while (len > 0 && (*line == ' ' || *line == '\t')) {
+        line++;
+        len--;
+    }
+    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == '\n' || line[len - 1] == ' ')) {
+        len--;
+    }
+    if (len < dst_size) {
+        memcpy(dst, line, len);
+        dst[len] = '\0';
+    }
+}
+
+static size_t HeaderCallback(void *contents, size_t size, size_t nmemb, HttpValidators *validators) {
+    const size_t realsize = size * nmemb;
+    copy_header_value(contents, realsize, "ETag", validators->etag, sizeof(validators->etag));
+    copy_header_value(
+        contents, realsize, "Last-Modified", validators->last_modified, sizeof(validators->last_modified)
+    );
+    return realsize;
+}
+
+// Fetch a space's SpaceAPI document. If the server says it hasn't changed since the copy space->is_open came from
+// (304 Not Modified), that state is returned as-is; otherwise the new validators are kept for next time.
+space_fetch_e get_space_state(hacker_space_t *space) {
+    const char *space_url = space->url;
     CURL *curl;
     CURLcode res;
     MemoryStruct chunk;
-    chunk.memory = malloc(1);
+    HttpValidators validators = {0};
+    struct curl_slist *headers = NULL;
+    space_fetch_e result = SPACE_FETCH_ERROR;
+    ALLOC_TAG_PUSH("curl");
+    chunk.memory = alloc_stats_malloc(1);
     chunk.size   = 0;
+    chunk.capacity = chunk.memory ? 1 : 0;
 
     curl = curl_easy_init();
     if (curl) {
@@ -192,32 +1223,496 @@ bool get_space_state(const char *space_url) {
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
         curl_easy_setopt(curl, CURLOPT_USERAGENT, "BadgeVMS-libcurl/1.0");
         curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, 128);
+        // One dead host must not hold up the loop for curl's default (minutes long) connect timeout
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, (long) SPACE_CONNECT_TIMEOUT_MS);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long) SPACE_TIMEOUT_MS);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)&validators);
+        if (space->etag[0] || space->last_modified[0]) {
+            char header[128];
+            if (space->etag[0]) {
+                SDL_snprintf(header, sizeof(header), "If-None-Match: %s", space->etag);
+                headers = curl_slist_append(headers, header);
+            }
+            if (space->last_modified[0]) {
+                SDL_snprintf(header, sizeof(header), "If-Modified-Since: %s", space->last_modified);
+                headers = curl_slist_append(headers, header);
+            }
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        }
 
+        TRACE_BEGIN("curl_easy_perform");
         res = curl_easy_perform(curl);
+        TRACE_END("curl_easy_perform");
+        long http_code = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+        g_fetch_stats.fetches++;
+        g_fetch_stats.body_bytes += chunk.size;
         if (res != CURLE_OK) {
             printf("curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
+        } else if (http_code == 304 && space->known) {
+            g_fetch_stats.not_modified++;
+            result = space->is_open ? SPACE_FETCH_OPEN : SPACE_FETCH_CLOSED;
+        } else if (http_code != 200) {
+            printf("HTTP %ld from %s\n", http_code, space_url);
         } else {
-            printf("Received %lu bytes:\n%s\n", (unsigned long)chunk.size, chunk.memory);
+            printf("Received %lu bytes\n", (unsigned long)chunk.size);
             // Remove whitespace
             remove_whitespace(chunk.memory);
             // Check if hacker space is open
             if (strstr(chunk.memory, "\"open\":true") != NULL) {
-                return true;
+                result = SPACE_FETCH_OPEN;
+            } else if (strstr(chunk.memory, "\"open\":") != NULL) {
+                result = SPACE_FETCH_CLOSED;
+            }
+            // Spaces from the directory come without coordinates: take them from location.lat/lon
+            char const *lat = strstr(chunk.memory, "\"lat\":");
+            char const *lon = strstr(chunk.memory, "\"lon\":");
+            if (result != SPACE_FETCH_ERROR && space->placed != PLACED_CONFIG && lat && lon) {
+                space_place(space, SDL_strtod(lat + 6, NULL), SDL_strtod(lon + 6, NULL), PLACED_DOCUMENT);
+                g_fetch_stats.cache_dirty = true;
+            }
+            if (result != SPACE_FETCH_ERROR &&
+                (strcmp(space->etag, validators.etag) != 0 ||
+                 strcmp(space->last_modified, validators.last_modified) != 0)) {
+                SDL_strlcpy(space->etag, validators.etag, sizeof(space->etag));
+                SDL_strlcpy(space->last_modified, validators.last_modified, sizeof(space->last_modified));
+                g_fetch_stats.cache_dirty = true;
             }
         }
 
         curl_easy_cleanup(curl);
+        curl_slist_free_all(headers);
     }
-    free(chunk.memory);
-    return false;
+    alloc_stats_free(chunk.memory);
+    ALLOC_TAG_POP();
+    return result;
 }
 
-int main(int argc, char *argv[]) {
-    printf("Space State NL app\n");
+// Scale `ms` by a random factor in [0.75, 1.25) so spaces that failed together don't retry together
+static Uint32 jitter_ms(const Uint32 ms) {
+    return ms - ms / 4 + (Uint32) SDL_rand((Sint32) SDL_max(1u, ms / 2));
+}
+
+// Record the outcome of a fetch and return how long to wait before the next one
+static Uint32 space_next_poll_ms(hacker_space_t *space, const space_fetch_e result) {
+    if (result == SPACE_FETCH_ERROR) {
+        space->failures++;
+        if (space->failures >= SPACE_BREAKER_FAILURES) {
+            if (space->failures == SPACE_BREAKER_FAILURES) {
+                printf("Space State NL - %s failed %d times, probing every %d minutes\n", space->display_name,
+                       space->failures, SPACE_BREAKER_MS / 60000);
+            }
+            return jitter_ms(SPACE_BREAKER_MS);
+        }
+        const Uint32 backoff = (Uint32) SPACE_RETRY_MS << (space->failures - 1);
+        return jitter_ms(SDL_min(backoff, (Uint32) SPACE_RETRY_MAX_MS));
+    }
+
+    const bool is_open = result == SPACE_FETCH_OPEN;
+    const bool changed = !space->known || is_open != space->is_open;
+    if (changed || space->interval_ms == 0) {
+        space->interval_ms = SPACE_POLL_MIN_MS; // something is happening there, keep a close eye on it
+    } else {
+        space->interval_ms = SDL_min(space->interval_ms + space->interval_ms / 2, (Uint32) SPACE_POLL_MAX_MS);
+    }
+    space->failures = 0;
+    space->known = true;
+    space->fresh = true;
+    space->is_open = is_open;
+    space_sync_counts_(space);
+    SDL_Time now;
+    if (SDL_GetCurrentTime(&now)) {
+        space->confirmed_at = now / SDL_NS_PER_SECOND;
+    }
+    // Every success moves confirmed_at; that alone isn't worth a flash write each poll
+    g_fetch_stats.confirmed = true;
+    if (changed || space->confirmed_at - g_fetch_stats.cache_saved_at >= SPACE_CACHE_CONFIRM_S) {
+        g_fetch_stats.cache_dirty = true;
+    }
+    return jitter_ms(space->interval_ms);
+}
+
+#ifdef ENABLE_FETCH_BENCH
+//
+// Fetch benchmark (ENABLE_FETCH_BENCH): once the link is up, fetch every polled space back to back for
+// FETCH_BENCH_ROUNDS rounds, report each round and quit. Meant to run against tools/spaceapi_stub: the first round
+// transfers whole documents, later ones show what conditional requests save, and injected faults show up as failed
+// fetches and in the longest fetch time.
+//
+
+#ifndef FETCH_BENCH_ROUNDS
+#define FETCH_BENCH_ROUNDS 5
+#endif
+
+static void fetch_bench(void) {
+    Uint64 total_ms = 0, total_bytes = 0, longest_ms = 0;
+    int total_fetches = 0, total_failed = 0;
+    for (int round = 1; round <= FETCH_BENCH_ROUNDS; round++) {
+        const Uint32 not_modified = g_fetch_stats.not_modified;
+        const Uint64 bytes = g_fetch_stats.body_bytes;
+        int fetches = 0, failed = 0;
+        char const *slowest = "-";
+        Uint64 slowest_ms = 0;
+        const Uint64 round_start = SDL_GetTicks();
+        for (int s = 0; s < g_space_state.count; s++) {
+            hacker_space_t *space = &g_space_state.spaces[s];
+            if (!space_wants_poll(space)) {
+                continue;
+            }
+            const Uint64 start = SDL_GetTicks();
+            const space_fetch_e result = get_space_state(space);
+            const Uint64 ms = SDL_GetTicks() - start;
+            space_next_poll_ms(space, result);
+            fetches++;
+            failed += result == SPACE_FETCH_ERROR;
+            if (ms >= slowest_ms) {
+                slowest_ms = ms;
+                slowest = space->display_name;
+            }
+        }
+        const Uint64 round_ms = SDL_GetTicks() - round_start;
+        const Uint64 round_bytes = g_fetch_stats.body_bytes - bytes;
+        printf("Space State NL - bench round %d: %d fetches in %llu ms, %d failed, %u not modified, %llu bytes, "
+               "%llu KB/s, slowest %s %llu ms\n",
+               round, fetches, (unsigned long long) round_ms, failed, g_fetch_stats.not_modified - not_modified,
+               (unsigned long long) round_bytes,
+               (unsigned long long) (round_bytes * 1000 / 1024 / SDL_max(round_ms, 1)), slowest,
+               (unsigned long long) slowest_ms);
+        total_ms += round_ms;
+        total_bytes += round_bytes;
+        total_fetches += fetches;
+        total_failed += failed;
+        longest_ms = SDL_max(longest_ms, slowest_ms);
+    }
+    printf("Space State NL - bench: %d rounds, %d fetches, %d failed, %llu ms per round, %llu bytes, longest fetch "
+           "%llu ms (timeout %d ms)\n",
+           FETCH_BENCH_ROUNDS, total_fetches, total_failed, (unsigned long long) (total_ms / FETCH_BENCH_ROUNDS),
+           (unsigned long long) total_bytes, (unsigned long long) longest_ms, SPACE_TIMEOUT_MS);
+}
+#endif
+
+//
+// Map view: zoom level 0 is the background asset; with a tile pyramid (tiles.h) in MAP_TILES_FILE the arrow keys pan
+// and +/- zoom through its levels. Only the tiles on screen are decoded, and while panning the next row or column of
+// tiles in that direction is read ahead between frames. Pins stay at their level 0 position scaled to the zoom.
+//
+
+#define MAP_TILES_FILE     "APPS:[SPACESTATE_NL]MAP.R5P"
+#define MAP_TILE_SLOTS     64 // 2 MB of 128x128 tiles: a screenful plus the next row or column
+#define MAP_PAN_STEP       120
+#define MAP_PREFETCH_TILES 2  // per main loop iteration
+
+static struct {
+    tiles_t tiles;
+    bool zoomable;
+    int zoom;
+    int x; // top-left corner of the screen, in pixels of the zoom level
+    int y;
+    int dx; // direction of the last pan, for read-ahead
+    int dy;
+} g_map = {0};
+
+static void map_open(void) {
+    g_map.zoomable = tiles_open(&g_map.tiles, MAP_TILES_FILE, MAP_TILE_SLOTS);
+    if (g_map.zoomable &&
+        (g_map.tiles.base_width != g_app_state.fb_width || g_map.tiles.base_height != g_app_state.fb_height)) {
+        printf("Space State NL - %s doesn't fit the background, not zooming\n", MAP_TILES_FILE);
+        tiles_close(&g_map.tiles);
+        g_map.zoomable = false;
+    }
+    if (g_map.zoomable) {
+        printf("Space State NL - map zooms %d levels\n", g_map.tiles.levels);
+    }
+}
+
+// Screen position of a space's pin at the current zoom: its tip stays on the same spot of the map
+static void map_pin_position(hacker_space_t const *space, int *x, int *y) {
+    const int w = g_assets[ASSET_PIN_GREEN].width;
+    const int h = g_assets[ASSET_PIN_GREEN].height;
+    const int scale = 1 << g_map.zoom; // not a shift: off-map spaces have negative coordinates
+    *x = (space->x + w / 2) * scale - g_map.x - w / 2;
+    *y = (space->y + h) * scale - g_map.y - h;
+}
+
+// Move the view by (dx, dy) pixels and/or `zoom` levels, keeping the screen's center in place when zooming.
+// False if nothing changed.
+static bool map_move(const int dx, const int dy, const int zoom) {
+    if (!g_map.zoomable) {
+        return false;
+    }
+    const int w = g_app_state.fb_width;
+    const int h = g_app_state.fb_height;
+    const int level = SDL_clamp(g_map.zoom + zoom, 0, g_map.tiles.levels);
+    // A center left of or above the map ends up clamped to 0 either way; don't shift it while negative
+    int x = SDL_max(g_map.x + dx + w / 2, 0);
+    int y = SDL_max(g_map.y + dy + h / 2, 0);
+    if (level > g_map.zoom) {
+        x <<= level - g_map.zoom;
+        y <<= level - g_map.zoom;
+    } else {
+        x >>= g_map.zoom - level;
+        y >>= g_map.zoom - level;
+    }
+    x = SDL_clamp(x - w / 2, 0, (w << level) - w);
+    y = SDL_clamp(y - h / 2, 0, (h << level) - h);
+    if (level == g_map.zoom && x == g_map.x && y == g_map.y) {
+        return false;
+    }
+    g_map.dx = (x > g_map.x) - (x < g_map.x);
+    g_map.dy = (y > g_map.y) - (y < g_map.y);
+    if (level != g_map.zoom) {
+        g_map.dx = g_map.dy = 0;
+    }
+    g_map.zoom = level;
+    g_map.x = x;
+    g_map.y = y;
+    return true;
+}
+
+// Redraw the map for the current view, with every pin moved to match
+static void map_render(window_handle_t window, uint16_t *framebuffer) {
+    uint16_t *background = g_app_state.clean_background;
+    const int w = g_app_state.fb_width;
+    const int h = g_app_state.fb_height;
+    TRACE_BEGIN("map_render");
+    if (g_map.zoom == 0) {
+        draw_asset(ASSET_BACKGROUND, background, w, h, 0, 0, NULL, 255);
+    } else {
+        tiles_draw(&g_map.tiles, g_map.zoom, g_map.x, g_map.y, background, w, h);
+    }
+    for (int s = 0; s < g_space_state.count; s++) {
+        hacker_space_t const *space = &g_space_state.spaces[s];
+        if (space->pin >= 0 && space->on_map) {
+            int x, y;
+            map_pin_position(space, &x, &y);
+            sprite_move(space->pin, x, y);
+        }
+    }
+    layers_redraw(window, framebuffer);
+    TRACE_END("map_render");
+}
+
+// Read ahead a few tiles in the pan direction; true if there may be more to read
+static bool map_prefetch(void) {
+    if (g_map.zoom == 0 || (g_map.dx == 0 && g_map.dy == 0)) {
+        return false;
+    }
+    TRACE_BEGIN("map_prefetch");
+    const int read = tiles_prefetch(
+        &g_map.tiles, g_map.zoom, g_map.x, g_map.y, g_app_state.fb_width, g_app_state.fb_height, g_map.dx, g_map.dy,
+        MAP_PREFETCH_TILES
+    );
+    TRACE_END("map_prefetch");
+    return read == MAP_PREFETCH_TILES;
+}
+
+// Pin for a space's last known state, faded while it hasn't been confirmed this run or the space stopped answering
+static void show_space_pin(hacker_space_t const *space) {
+    if (space->pin < 0 || !space->on_map || !space->known) {
+        return;
+    }
+    const bool stale = !space->fresh || space->failures > 0;
+    int x, y;
+    map_pin_position(space, &x, &y);
+    sprite_move(space->pin, x, y);
+    sprite_set_image(space->pin, space->is_open ? ASSET_PIN_GREEN : ASSET_PIN_RED, stale ? STALE_PIN_OPACITY : 255);
+}
+
+// SPACE_CACHE_FILE holds one line per space: url, open (0/1), confirmed_at, ETag, Last-Modified, and for spaces placed
+// by their own document lat and lon; tab-separated
+static void load_space_cache(void) {
+    SDL_Time now = 0;
+    SDL_GetCurrentTime(&now);
+    FILE *f = fopen(SPACE_CACHE_FILE, "r");
+    if (f == NULL) {
+        return;
+    }
+    g_fetch_stats.cache_saved_at = now / SDL_NS_PER_SECOND;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char *fields[7];
+        const int n = split_tabs(line, fields, 7);
+        const int i = n >= 5 ? space_find_by_url(fields[0]) : -1;
+        if (i < 0) {
+            continue;
+        }
+        hacker_space_t *space = &g_space_state.spaces[i];
+        const Sint64 confirmed_at = SDL_strtoll(fields[2], NULL, 10);
+        space->is_open = fields[1][0] == '1';
+        space->known = now / SDL_NS_PER_SECOND - confirmed_at < SNAPSHOT_MAX_AGE_S;
+        space->confirmed_at = confirmed_at;
+        if (space->known) {
+            SDL_strlcpy(space->etag, fields[3], sizeof(space->etag));
+            SDL_strlcpy(space->last_modified, fields[4], sizeof(space->last_modified));
+        }
+        if (n == 7 && space->placed == PLACED_NONE) {
+            space_place(space, SDL_strtod(fields[5], NULL), SDL_strtod(fields[6], NULL), PLACED_DOCUMENT);
+        }
+        space_sync_counts_(space);
+    }
+    fclose(f);
+}
+
+static void save_space_cache(void) {
+    FILE *f = fopen(SPACE_CACHE_FILE, "w");
+    if (f == NULL) {
+        printf("Space State NL - could not write %s\n", SPACE_CACHE_FILE);
+        return;
+    }
+    for (int s = 0; s < g_space_state.count; s++) {
+        hacker_space_t const *space = &g_space_state.spaces[s];
+        if (!space->known && space->placed != PLACED_DOCUMENT) {
+            continue;
+        }
+        fprintf(f, "%s\t%d\t%lld\t%s\t%s", space->url, space->is_open, (long long) space->confirmed_at,
+                space->etag, space->last_modified);
+        if (space->placed == PLACED_DOCUMENT) {
+            fprintf(f, "\t%.5f\t%.5f", space->lat, space->lon);
+        }
+        fputc('\n', f);
+    }
+    fclose(f);
+    SDL_Time now;
+    if (SDL_GetCurrentTime(&now)) {
+        g_fetch_stats.cache_saved_at = now / SDL_NS_PER_SECOND;
+    }
+    g_fetch_stats.cache_dirty = false;
+    g_fetch_stats.confirmed = false;
+}
+
+// Wi-Fi comes up on its own thread so the map stays responsive while the badge associates. The worker only reports
+// through atomics; the main loop looks at them on TIMER_WIFI and starts fetching once the link is up.
+#define WIFI_POLL_MS      250
+#define WIFI_RETRY_MS     (10 * 1000) // between wifi_connect() attempts while disconnected
+#define WIFI_RSSI_MS      (5 * 1000)
+#define WIFI_UI_MS        500         // label refresh while connecting
+#define WIFI_UI_UP_MS     (5 * 1000)  // link check once up
+
+typedef enum {
+    LINK_CONNECTING,
+    LINK_UP,
+    LINK_WRONG_CREDENTIALS,
+    LINK_DISABLED,
+    LINK_ERROR,
+} link_state_e;
+
+static struct {
+    SDL_Thread *thread;
+    SDL_AtomicInt state;    // link_state_e
+    SDL_AtomicInt rssi;     // dBm, 0 if unknown
+    SDL_AtomicInt attempts; // wifi_connect() calls so far
+    SDL_AtomicInt quit;
+    char ssid[33];          // written once, before state first becomes LINK_UP
+} g_wifi;
 
 #ifdef WHY_BADGE
-    wifi_connect();
+static int wifi_worker_(void *userdata) {
+    (void) userdata;
+    if (wifi_get_status() == WIFI_DISABLED) {
+        SDL_SetAtomicInt(&g_wifi.state, LINK_DISABLED);
+        return 0;
+    }
+    Uint64 next_attempt = 0;
+    Uint64 next_rssi = 0;
+    while (!SDL_GetAtomicInt(&g_wifi.quit)) {
+        const Uint64 now = SDL_GetTicks();
+        const wifi_connection_status_t status = wifi_get_connection_status();
+        if (status == WIFI_CONNECTED) {
+            if (now >= next_rssi) {
+                // Owned by the Wi-Fi stack, only read here
+                wifi_station_handle station = wifi_get_connection_station();
+                if (station) {
+                    if (g_wifi.ssid[0] == '\0') {
+                        SDL_strlcpy(g_wifi.ssid, wifi_station_get_ssid(station), sizeof(g_wifi.ssid));
+                    }
+                    SDL_SetAtomicInt(&g_wifi.rssi, wifi_station_get_rssi(station));
+                }
+                next_rssi = now + WIFI_RSSI_MS;
+            }
+            SDL_SetAtomicInt(&g_wifi.state, LINK_UP);
+        } else if (status == WIFI_ERROR_WRONG_CREDENTIALS) {
+            SDL_SetAtomicInt(&g_wifi.state, LINK_WRONG_CREDENTIALS);
+            return 0; // the same password won't work any better next time
+        } else {
+            SDL_SetAtomicInt(&g_wifi.state, status == WIFI_ERROR ? LINK_ERROR : LINK_CONNECTING);
+            if (now >= next_attempt) {
+                SDL_AddAtomicInt(&g_wifi.attempts, 1);
+                // Blocks while associating; only this thread waits on it
+                if (wifi_connect() == WIFI_ERROR_WRONG_CREDENTIALS) {
+                    SDL_SetAtomicInt(&g_wifi.state, LINK_WRONG_CREDENTIALS);
+                    return 0;
+                }
+                next_attempt = SDL_GetTicks() + WIFI_RETRY_MS;
+                continue;
+            }
+        }
+        SDL_Delay(WIFI_POLL_MS);
+    }
+    return 0;
+}
 #endif
+
+static void wifi_link_start(void) {
+#ifdef WHY_BADGE
+    SDL_SetAtomicInt(&g_wifi.state, LINK_CONNECTING);
+    g_wifi.thread = SDL_CreateThread(wifi_worker_, "wifi", NULL);
+    if (g_wifi.thread == NULL) {
+        printf("Space State NL - no Wi-Fi thread (%s), connecting inline\n", SDL_GetError());
+        const wifi_connection_status_t status = wifi_connect();
+        SDL_SetAtomicInt(
+            &g_wifi.state, status == WIFI_CONNECTED                 ? LINK_UP
+                           : status == WIFI_ERROR_WRONG_CREDENTIALS ? LINK_WRONG_CREDENTIALS
+                                                                    : LINK_ERROR
+        );
+    }
+#else
+    SDL_SetAtomicInt(&g_wifi.state, LINK_UP); // the desktop build uses the host's network
+#endif
+}
+
+static void wifi_link_stop(void) {
+    SDL_SetAtomicInt(&g_wifi.quit, 1);
+    if (g_wifi.thread) {
+        // A worker stuck in wifi_connect() must not hold up exit
+        SDL_DetachThread(g_wifi.thread);
+        g_wifi.thread = NULL;
+    }
+}
+
+// Describe the link for the status label; true once it is up
+static bool wifi_link_status(char *text, const size_t size, const Uint64 since) {
+    const link_state_e state = (link_state_e) SDL_GetAtomicInt(&g_wifi.state);
+    const int rssi = SDL_GetAtomicInt(&g_wifi.rssi);
+    switch (state) {
+        case LINK_UP:
+            if (rssi != 0) {
+                SDL_snprintf(text, size, "Wi-Fi %s, %d dBm", g_wifi.ssid, rssi);
+            } else {
+                SDL_strlcpy(text, "Wi-Fi connected", size);
+            }
+            return true;
+        case LINK_WRONG_CREDENTIALS:
+            SDL_strlcpy(text, "Wi-Fi: wrong password, check settings", size);
+            return false;
+        case LINK_DISABLED:
+            SDL_strlcpy(text, "Wi-Fi is disabled, showing saved state", size);
+            return false;
+        case LINK_ERROR:
+        case LINK_CONNECTING:
+        default:
+            SDL_snprintf(
+                text, size, "%s Wi-Fi... %us (try %d)", state == LINK_ERROR ? "Retrying" : "Connecting to",
+                (unsigned) ((SDL_GetTicks() - since) / 1000), SDL_max(1, SDL_GetAtomicInt(&g_wifi.attempts))
+            );
+            return false;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    alloc_stats_install();
+    printf("Space State NL app\n");
     curl_global_init(0);
 
     // Create window / frame buffer
@@ -228,97 +1723,240 @@ int main(int argc, char *argv[]) {
     framebuffer_t  *framebuffer = window_framebuffer_create(window, size, BADGEVMS_PIXELFORMAT_RGB565);
     printf("Space State NL - created window\n");
 
-    printf("Space State NL - Checking background image...\n");
-    FILE *f_background = fopen(BACKGROUND_IMAGE, "r"); //read
-    if (f_background == NULL) {
-        printf("Space State NL - Background image not found\n");
-        f_background = fopen(BACKGROUND_IMAGE, "wb"); //write binary
-        fwrite(background_png, 1, background_png_len, f_background);
-        fclose(f_background);
-        printf("Space State NL - Background image created\n");
-    }
-
-    printf("Space State NL - Checking pin_green image...\n");
-    FILE *f_pin_green = fopen(PIN_GREEN, "r"); //read
-    if (f_pin_green == NULL) {
-        printf("Space State NL - pin_green image not found\n");
-        f_pin_green = fopen(PIN_GREEN, "wb"); //write binary
-        fwrite(pin_green_png, 1, pin_green_png_len, f_pin_green);
-        fclose(f_pin_green);
-        printf("Space State NL - pin_green image created\n");
-    }
-
-    printf("Space State NL - Checking pin_red image...\n");
-    FILE *f_pin_red = fopen(PIN_RED, "r"); //read
-    if (f_pin_red == NULL) {
-        printf("Space State NL - pin_red image not found\n");
-        f_pin_red = fopen(PIN_RED, "wb"); //write binary
-        fwrite(pin_red_png, 1, pin_red_png_len, f_pin_red);
-        fclose(f_pin_red);
-        printf("Space State NL - pin_red image created\n");
-    }
-
     // Render background
-    render_png_to_framebuffer(
-        framebuffer->pixels,
-        framebuffer->w,
-        framebuffer->h,
-        BACKGROUND_IMAGE,
-        0,
-        0
-    );
+    load_assets();
+    TRACE_BEGIN("draw_background");
+    draw_asset(ASSET_BACKGROUND, framebuffer->pixels, framebuffer->w, framebuffer->h, 0, 0, NULL, 255);
+    TRACE_END("draw_background");
+    window_present(window, true, NULL, 0);
     printf("Space State NL - rendered background\n");
 
     g_app_state.fb_width = framebuffer->w;
     g_app_state.fb_height = framebuffer->h;
-    g_app_state.clean_background = malloc(framebuffer->w * framebuffer->h * sizeof(uint16_t));
+    g_app_state.clean_background = alloc_stats_malloc(framebuffer->w * framebuffer->h * sizeof(uint16_t));
     memcpy(g_app_state.clean_background, framebuffer->pixels, framebuffer->w * framebuffer->h * sizeof(uint16_t));
     printf("Space State NL - saved background\n");
+    map_open();
+
+    // Warm start: the last known states go up before the network is even there
+    load_spaces();
+    load_space_cache();
+    for (int s = 0; s < g_space_state.count; s++) {
+        hacker_space_t *space = &g_space_state.spaces[s];
+        if (space->url) {
+            space->history = history_track(&g_history, space_hash_(space->url));
+        }
+    }
+    // Not before the badge's clock is set (e.g. by time sync once online): then it's retried with the first observation
+    bool history_loaded = history_load(&g_history, HISTORY_FILE);
+
+    // A pin for every space that is or may turn out to be on the map (shown once its state is known), then the
+    // status label and the history panel on top
+    layers_init(g_space_state.count + 2);
+    for (int s = 0; s < g_space_state.count; s++) {
+        hacker_space_t *space = &g_space_state.spaces[s];
+        if (space_wants_poll(space) || space->on_map) {
+            space->pin = sprite_add(SPRITE_IMAGE, space->x, space->y);
+            show_space_pin(space);
+        }
+    }
+    const int status_sprite = sprite_add(SPRITE_LABEL, 8, framebuffer->h - FONT_HEIGHT - 2 * LABEL_PADDING - 8);
+    sprite_set_text(status_sprite, "Connecting...");
+    const int history_sprite = sprite_add(SPRITE_HISTORY, 8, 8);
+    int history_space = -1;
+    layers_flush(window, framebuffer->pixels);
+    printf("Space State NL - first frame after %llu ms\n", (unsigned long long) SDL_GetTicks());
+
+    // Space timers are armed once TIMER_WIFI sees the link come up
+    const Uint64 wifi_started = SDL_GetTicks();
+    wifi_link_start();
+    bool link_up = false;
+    timers_t timers;
+    timers_init(&timers, TIMER_SPACES + g_space_state.count);
+    timers_set(&timers, TIMER_WIFI, SDL_GetTicks());
 
-    uint32_t big_timestamp = 0;
-    uint32_t big_interval = 30*1000;
-    uint32_t small_timestamp = 0;
-    uint32_t small_interval = 250;
+    watchdog_start(WATCHDOG_BUDGET_MS);
 
-    // Main loop
-    int i = 0;
+    // Main loop: sleep until input or the next deadline, then do whatever is due
     while(true) {
-        event_t e = window_event_poll(window, false, 0);
+        const Uint32 wait_ms = timers_wait_ms(&timers, SDL_GetTicks(), IDLE_WAIT_MAX_MS);
+        event_t e = window_event_poll(window, wait_ms > 0, wait_ms);
+        watchdog_frame_begin();
+        TRACE_BEGIN("frame");
         if (e.type == EVENT_KEY_DOWN) {
             if (e.keyboard.scancode == KEY_SCANCODE_ESCAPE) {
                 printf("Space State NL - ESCAPE KEY\n");
+                TRACE_END("frame");
+                watchdog_frame_end();
                 break; //exit loop
             }
+            bool moved = false;
+            switch (e.keyboard.scancode) {
+                case KEY_SCANCODE_LEFT: moved = map_move(-MAP_PAN_STEP, 0, 0); break;
+                case KEY_SCANCODE_RIGHT: moved = map_move(MAP_PAN_STEP, 0, 0); break;
+                case KEY_SCANCODE_UP: moved = map_move(0, -MAP_PAN_STEP, 0); break;
+                case KEY_SCANCODE_DOWN: moved = map_move(0, MAP_PAN_STEP, 0); break;
+                case KEY_SCANCODE_EQUALS:
+                case KEY_SCANCODE_KP_PLUS: moved = map_move(0, 0, 1); break;
+                case KEY_SCANCODE_MINUS:
+                case KEY_SCANCODE_KP_MINUS: moved = map_move(0, 0, -1); break;
+                case KEY_SCANCODE_H:
+                    if (g_layers.sprites[history_sprite].visible) {
+                        sprite_hide(history_sprite);
+                        break;
+                    }
+                    if (history_space < 0) {
+                        history_space = next_pinned_space(-1);
+                    }
+                    if (history_space >= 0) {
+                        sprite_set_history(history_sprite, history_space);
+                    }
+                    break;
+                case KEY_SCANCODE_TAB:
+                    history_space = next_pinned_space(history_space);
+                    if (history_space >= 0) {
+                        sprite_set_history(history_sprite, history_space);
+                    }
+                    break;
+                default: break;
+            }
+            if (moved) {
+                map_render(window, framebuffer->pixels);
+                timers_set(&timers, TIMER_PREFETCH, SDL_GetTicks());
+            }
+#ifdef ENABLE_TRACE
+            if (e.keyboard.scancode == KEY_SCANCODE_F12) {
+                trace_dump(TRACE_OUTPUT_PATH);
+            }
+#endif
         }
 
-        uint32_t current_time = time(NULL) * 1000;
-        if (current_time - big_timestamp >= big_interval) {
-            if (current_time - small_timestamp >= small_interval) {
-                // Check Spaces
-                printf("Space State NL - Checking %s %s", g_space_state.hackerspaces[i].display_name, "...");
-                bool isOpen = get_space_state(g_space_state.hackerspaces[i].url);
-                g_space_state.hackerspaces[i].is_open = isOpen;
-                if (isOpen) {
-                    printf("Space State NL - Checking %s %s", g_space_state.hackerspaces[i].display_name, " is OPEN");
-                    render_png_with_alpha_scaled(framebuffer->pixels, g_app_state.fb_width, g_app_state.fb_height, PIN_GREEN, g_space_state.hackerspaces[i].x, g_space_state.hackerspaces[i].y, 1);
-                } else {
-                    printf("Space State NL - Checking %s %s", g_space_state.hackerspaces[i].display_name, " is CLOSED");
-                    render_png_with_alpha_scaled(framebuffer->pixels, g_app_state.fb_width, g_app_state.fb_height, PIN_RED, g_space_state.hackerspaces[i].x, g_space_state.hackerspaces[i].y, 1);
+        // One fetch per iteration, so input is looked at between fetches
+        const int i = timers_pop_due(&timers, SDL_GetTicks());
+        if (i == TIMER_WIFI) {
+            char status[LABEL_MAX_TEXT];
+            const bool up = wifi_link_status(status, sizeof(status), wifi_started);
+            if (up && !link_up) {
+                printf("Space State NL - %s after %llu ms\n", status,
+                       (unsigned long long) (SDL_GetTicks() - wifi_started));
+#ifdef ENABLE_FETCH_BENCH
+                TRACE_END("frame");
+                watchdog_frame_end();
+                fetch_bench();
+                break;
+#endif
+                // Every space polls on its own timer, staggered so the first round doesn't burst
+                Uint64 start = SDL_GetTicks();
+                for (int s = 0; s < g_space_state.count; s++) {
+                    if (space_wants_poll(&g_space_state.spaces[s])) {
+                        timers_set(&timers, TIMER_SPACES + s, start);
+                        start += SPACE_POLL_STAGGER_MS;
+                    }
                 }
-                i++;
-                small_timestamp = current_time;
-                if (i>=NUM_HACKER_SPACES) {
-                    printf("Space State NL - Checked all, waiting for about 30 seconds");
-                    i = 0;
-                    big_timestamp = current_time;
+            }
+            if (up != link_up || !up) {
+                sprite_set_text(status_sprite, status);
+            }
+            link_up = up;
+            const link_state_e state = (link_state_e) SDL_GetAtomicInt(&g_wifi.state);
+            if (state == LINK_UP || state == LINK_CONNECTING || state == LINK_ERROR) {
+                timers_set(&timers, TIMER_WIFI, SDL_GetTicks() + (up ? WIFI_UI_UP_MS : WIFI_UI_MS));
+            }
+        } else if (i == TIMER_PREFETCH) {
+            if (map_prefetch()) {
+                timers_set(&timers, TIMER_PREFETCH, SDL_GetTicks());
+            }
+        } else if (i == TIMER_HISTORY) {
+            TRACE_BEGIN("history_flush");
+            history_flush(&g_history, HISTORY_FILE, false);
+            TRACE_END("history_flush");
+        } else if (i == TIMER_SAVE_CACHE) {
+            TRACE_BEGIN("save_space_cache");
+            save_space_cache();
+            TRACE_END("save_space_cache");
+        } else if (i >= TIMER_SPACES) {
+            // Check Spaces
+            hacker_space_t *space = &g_space_state.spaces[i - TIMER_SPACES];
+            char status[LABEL_MAX_TEXT];
+            SDL_snprintf(status, sizeof(status), "Checking %s...", space->display_name);
+            sprite_set_text(status_sprite, status);
+            layers_flush(window, framebuffer->pixels);
+            printf("Space State NL - Checking %s %s", space->display_name, "...");
+            TRACE_BEGIN("get_space_state");
+            const space_fetch_e result = get_space_state(space);
+            TRACE_END("get_space_state");
+            space->last_checked = SDL_GetTicks();
+            const Uint32 next_ms = space_next_poll_ms(space, result);
+            if (result == SPACE_FETCH_ERROR) {
+                printf("Space State NL - Checking %s failed, retry in %u s\n", space->display_name, next_ms / 1000);
+            } else {
+                printf(
+                    "Space State NL - Checking %s %s", space->display_name, space->is_open ? " is OPEN" : " is CLOSED"
+                );
+            }
+            const Sint32 slot = history_slot_now();
+            if (!history_loaded && slot >= 0) {
+                history_loaded = history_load(&g_history, HISTORY_FILE);
+            }
+            if (result != SPACE_FETCH_ERROR && space->history >= 0 && slot >= 0) {
+                history_observe(&g_history, space->history, slot, space->is_open);
+                if (g_history.pending_size > 0 && !timers_armed(&timers, TIMER_HISTORY)) {
+                    timers_set(&timers, TIMER_HISTORY, space->last_checked + HISTORY_FLUSH_MS);
                 }
             }
-        }
+            if (i - TIMER_SPACES == history_space) {
+                sprite_refresh(history_sprite);
+            }
+            show_space_pin(space);
+            if (space_wants_poll(space)) {
+                timers_set(&timers, i, space->last_checked + next_ms);
+            } else {
+                printf("Space State NL - %s is not on the map, no longer polled\n", space->display_name);
+            }
+            if (g_fetch_stats.cache_dirty && !timers_armed(&timers, TIMER_SAVE_CACHE)) {
+                timers_set(&timers, TIMER_SAVE_CACHE, space->last_checked + SPACE_CACHE_SAVE_MS);
+            }
 
+            const int rssi = SDL_GetAtomicInt(&g_wifi.rssi);
+            const int open = g_space_state.open_count;
+            if (rssi != 0) {
+                SDL_snprintf(status, sizeof(status), "%d of %d spaces open, %d dBm", open, g_space_state.mapped, rssi);
+            } else {
+                SDL_snprintf(status, sizeof(status), "%d of %d spaces open", open, g_space_state.mapped);
+            }
+            sprite_set_text(status_sprite, status);
+        }
 
-        window_present(window, true, NULL, 0);
+        TRACE_BEGIN("draw_sprites");
+        layers_flush(window, framebuffer->pixels);
+        TRACE_END("draw_sprites");
+        TRACE_END("frame");
+        watchdog_frame_end();
+    }
+    timers_destroy(&timers);
+    wifi_link_stop();
+    if (g_fetch_stats.cache_dirty || g_fetch_stats.confirmed) {
+        save_space_cache();
     }
+    history_flush(&g_history, HISTORY_FILE, true);
+    history_destroy(&g_history);
+    printf("Space State NL - %u fetches, %u not modified, %llu body bytes\n", g_fetch_stats.fetches,
+           g_fetch_stats.not_modified, (unsigned long long) g_fetch_stats.body_bytes);
+    watchdog_stop();
+    watchdog_dump(WATCHDOG_OUTPUT_PATH);
 
+    trace_dump(TRACE_OUTPUT_PATH);
+    if (g_map.zoomable) {
+        printf("Space State NL - tiles: %u hits, %u misses, %u evictions\n", g_map.tiles.hits, g_map.tiles.misses,
+               g_map.tiles.evictions);
+        tiles_close(&g_map.tiles);
+    }
+    layers_destroy();
+    assets_destroy();
+    spaces_destroy();
+    alloc_stats_free(g_app_state.clean_background);
+    curl_global_cleanup();
+    alloc_stats_report();
     printf("Space State NL - END OF MAIN\n");
     return 0;
 }
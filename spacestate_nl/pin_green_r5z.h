@@ -0,0 +1,141 @@
+// Generated by tools/r5zenc, do not edit
+unsigned char const pin_green_r5z[] = {
+  0x52, 0x35, 0x5a, 0x31, 0x23, 0x00, 0x32, 0x00, 0x84, 0x02, 0x00, 0x00,
+  0x66, 0x06, 0x00, 0x00, 0xcb, 0xfe, 0x89, 0x36, 0xfe, 0x94, 0xaf, 0xa2,
+  0x88, 0x6e, 0xc1, 0x6b, 0xc0, 0x0b, 0x55, 0xfe, 0xca, 0x3e, 0xd5, 0x3c,
+  0x6f, 0x76, 0x9c, 0x99, 0x9d, 0x89, 0x9d, 0x99, 0x55, 0x55, 0x38, 0x07,
+  0x16, 0xa4, 0x76, 0x06, 0x0b, 0x3c, 0xd1, 0x06, 0x0b, 0x9d, 0x89, 0x99,
+  0xa9, 0x9b, 0x9a, 0xc9, 0xa4, 0x76, 0xa7, 0x67, 0x0b, 0x3c, 0xcd, 0x9d,
+  0x13, 0x0b, 0x52, 0x96, 0xcb, 0x29, 0xcd, 0x3b, 0x3e, 0x0b, 0x9c, 0x34,
+  0xca, 0xa0, 0xcb, 0x0b, 0x99, 0x9a, 0x29, 0xd1, 0x1b, 0x0b, 0x9e, 0x56,
+  0xc8, 0x9f, 0xb9, 0x0b, 0x96, 0xbc, 0x29, 0xd3, 0x05, 0x0b, 0x40, 0xc6,
+  0x9f, 0x24, 0x0b, 0x0c, 0x29, 0xd5, 0x00, 0x0b, 0x9d, 0x88, 0xc5, 0x0b,
+  0x16, 0x29, 0xd7, 0xa6, 0x65, 0x0b, 0xc4, 0x3c, 0x39, 0x29, 0xd9, 0xab,
+  0x54, 0x3c, 0xc2, 0xfe, 0xca, 0x3e, 0x0b, 0x93, 0xbc, 0x62, 0xd9, 0x6e,
+  0x0b, 0x9a, 0x12, 0xc1, 0x3c, 0x28, 0x29, 0xd3, 0x33, 0x2d, 0x62, 0x2e,
+  0x29, 0xc2, 0x1b, 0xa7, 0x65, 0xc1, 0x7f, 0x33, 0x29, 0xd2, 0x33, 0xac,
+  0x44, 0x4c, 0x01, 0x39, 0x2e, 0x29, 0xc1, 0x2e, 0x0b, 0xc0, 0x9e, 0x66,
+  0x3e, 0x29, 0xd2, 0x33, 0x03, 0x5d, 0xc1, 0x7f, 0x16, 0x29, 0xc2, 0xac,
+  0x54, 0x4c, 0x0b, 0x9a, 0xaa, 0x29, 0xd1, 0x33, 0x03, 0x01, 0xc1, 0x66,
+  0xa1, 0x9a, 0x00, 0x29, 0xc2, 0x16, 0x01, 0x0b, 0x0c, 0x29, 0xd0, 0x33,
+  0x03, 0x3e, 0xc1, 0x3c, 0xa2, 0x99, 0x0c, 0x29, 0xc3, 0x3b, 0x0b, 0x10,
+  0x93, 0xbc, 0x29, 0xc4, 0xa6, 0x66, 0x1b, 0x29, 0xc7, 0x33, 0x03, 0x59,
+  0xc1, 0x3c, 0x17, 0x0c, 0x29, 0xc5, 0xb0, 0x42, 0x0b, 0x2e, 0x29, 0xc3,
+  0xa9, 0x55, 0x10, 0x01, 0x9c, 0xab, 0x29, 0xc5, 0x33, 0x03, 0x3e, 0xc1,
+  0x06, 0x17, 0x0c, 0x29, 0xc6, 0x0b, 0x1a, 0x29, 0xc3, 0x00, 0x10, 0xc1,
+  0x3e, 0x32, 0x29, 0xc3, 0x33, 0x03, 0x01, 0xc2, 0x13, 0x0c, 0x29, 0xc7,
+  0x3c, 0x0b, 0x2e, 0x29, 0xc2, 0x38, 0x10, 0xfe, 0x4b, 0x4f, 0xc1, 0x01,
+  0x32, 0x2e, 0x29, 0xc0, 0x33, 0x03, 0x3e, 0xc1, 0x0b, 0x10, 0x0c, 0x29,
+  0xc8, 0x0b, 0x10, 0x38, 0x29, 0xc3, 0x16, 0x10, 0xfe, 0x4b, 0x47, 0xc1,
+  0x01, 0x32, 0x2e, 0x33, 0x03, 0xa2, 0x76, 0xc1, 0x51, 0x10, 0x11, 0x29,
+  0xc8, 0x2e, 0x0b, 0xc0, 0x0c, 0x29, 0xc4, 0xa8, 0x65, 0x13, 0xfe, 0x6c,
+  0x4f, 0xc1, 0x01, 0x63, 0x03, 0x06, 0xc1, 0x9c, 0x78, 0x10, 0x11, 0x29,
+  0xc9, 0xa4, 0x77, 0x10, 0x0b, 0x23, 0x29, 0xc5, 0x1e, 0x10, 0xc2, 0x06,
+  0x01, 0xc2, 0x10, 0x11, 0x29, 0xca, 0x1e, 0x0b, 0x9c, 0x56, 0x37, 0x29,
+  0xc6, 0xa8, 0x55, 0x0d, 0xc4, 0x32, 0x10, 0x96, 0xbb, 0x29, 0xcb, 0xad,
+  0x54, 0x44, 0xc0, 0x10, 0x33, 0x29, 0xc6, 0x23, 0x08, 0xc2, 0x58, 0x10,
+  0x11, 0x29, 0xcb, 0x33, 0x0b, 0xc2, 0x20, 0x29, 0xc7, 0x20, 0xa6, 0x65,
+  0xc1, 0x10, 0x0a, 0x29, 0xcc, 0x23, 0x01, 0xc1, 0x98, 0x24, 0x0b, 0x29,
+  0xc8, 0x23, 0x08, 0x10, 0x0a, 0x29, 0xcd, 0x0b, 0x9c, 0x13, 0xc2, 0x0b,
+  0x98, 0xab, 0x29, 0xc8, 0x3b, 0x33, 0x29, 0xcd, 0x1e, 0x01, 0xc3, 0x0c,
+  0x0b, 0x2e, 0x29, 0xd7, 0x2e, 0x0b, 0x9c, 0x66, 0xc4, 0x01, 0x9b, 0xaa,
+  0x29, 0xd7, 0x28, 0xa5, 0x76, 0xc5, 0xfe, 0xea, 0x3e, 0x0b, 0x38, 0x29,
+  0xd5, 0x3b, 0x0b, 0xfe, 0xe9, 0x3e, 0xc6, 0x2d, 0x3e, 0x29, 0xd5, 0xac,
+  0x43, 0x01, 0xc8, 0x04, 0x16, 0x29, 0xd3, 0xa7, 0x65, 0x0b, 0xc9, 0x9d,
+  0x66, 0x0b, 0x33, 0x29, 0xd1, 0x33, 0x0b, 0x1e, 0xca, 0x3c, 0x32, 0x29,
+  0xd1, 0x32, 0x01, 0xcd, 0x16, 0x29, 0xcf, 0x11, 0x10, 0xcd, 0x9d, 0x66,
+  0x0b, 0x33, 0x29, 0xcd, 0x33, 0x0b, 0x2d, 0xce, 0x37, 0x32, 0x29, 0xcd,
+  0x32, 0x0b, 0xd0, 0x01, 0x16, 0x29, 0xcb, 0x0a, 0x0b, 0xd1, 0x1e, 0x04,
+  0x33, 0x29, 0xc9, 0x6e, 0xad, 0x54, 0x1e, 0xd2, 0xa2, 0x88, 0x73, 0x29,
+  0xc9, 0xab, 0x54, 0x3c, 0xd4, 0x0b, 0x0a, 0x29, 0xc7, 0x05, 0x0b, 0xd5,
+  0x1e, 0x0b, 0x2e, 0x29, 0xc5, 0x2e, 0x0b, 0x9e, 0x67, 0xd6, 0x39, 0x2d,
+  0x29, 0xc5, 0x28, 0x01, 0xd8, 0x0b, 0x05, 0x29, 0xc3, 0xa4, 0x66, 0x10,
+  0xd9, 0x23, 0x06, 0x2e, 0x29, 0xc1, 0x2e, 0x06, 0xa0, 0x56, 0xda, 0x0b,
+  0x28, 0x29, 0xc1, 0x28, 0x01, 0xdc, 0x0b, 0x3d, 0x29, 0x3d, 0x10, 0xfe,
+  0xa8, 0x1e, 0xdc, 0x23, 0x06, 0x2e, 0x06, 0x48, 0xde, 0x3c, 0x0b, 0x01,
+  0xdf, 0x94, 0x13, 0x0b, 0xfe, 0xaa, 0x46, 0xcf, 0x0b, 0x00, 0x00, 0x06,
+  0x00, 0x3d, 0x00, 0x74, 0x00, 0x94, 0x00, 0xa3, 0x00, 0xa8, 0x00, 0xa2,
+  0x00, 0x94, 0x00, 0x70, 0x00, 0x3d, 0x00, 0x06, 0x15, 0x00, 0x00, 0x3d,
+  0x00, 0xa1, 0x00, 0xe8, 0x00, 0xf7, 0x00, 0xf6, 0x00, 0xf5, 0x00, 0xfc,
+  0x00, 0xf6, 0x00, 0xfb, 0x01, 0xf3, 0x00, 0xf2, 0x00, 0xef, 0x00, 0xa4,
+  0x00, 0x3f, 0x11, 0x00, 0x00, 0x35, 0x00, 0xc1, 0x00, 0xf3, 0x00, 0xf5,
+  0x00, 0xfe, 0x08, 0xff, 0x00, 0xfe, 0x00, 0xf1, 0x00, 0xf3, 0x00, 0xc4,
+  0x00, 0x37, 0x0d, 0x00, 0x00, 0x04, 0x00, 0x8e, 0x00, 0xf7, 0x00, 0xf8,
+  0x0e, 0xff, 0x01, 0xf2, 0x00, 0x95, 0x00, 0x09, 0x0a, 0x00, 0x00, 0x15,
+  0x00, 0xc2, 0x00, 0xf4, 0x00, 0xfd, 0x10, 0xff, 0x00, 0xfd, 0x00, 0xf8,
+  0x00, 0xc8, 0x00, 0x1a, 0x08, 0x00, 0x00, 0x11, 0x00, 0xcc, 0x00, 0xed,
+  0x14, 0xff, 0x00, 0xf8, 0x00, 0xda, 0x00, 0x1e, 0x06, 0x00, 0x00, 0x08,
+  0x00, 0xc1, 0x00, 0xed, 0x16, 0xff, 0x00, 0xfa, 0x00, 0xcf, 0x00, 0x0e,
+  0x05, 0x00, 0x00, 0x97, 0x00, 0xf6, 0x18, 0xff, 0x00, 0xf7, 0x00, 0xac,
+  0x04, 0x00, 0x00, 0x49, 0x00, 0xf8, 0x00, 0xfe, 0x19, 0xff, 0x00, 0xf1,
+  0x00, 0x58, 0x02, 0x00, 0x00, 0x02, 0x00, 0xd3, 0x00, 0xfa, 0x1a, 0xff,
+  0x00, 0xfb, 0x00, 0xe0, 0x00, 0x08, 0x01, 0x00, 0x00, 0x56, 0x00, 0xf8,
+  0x14, 0xff, 0x00, 0xfa, 0x00, 0xf3, 0x00, 0xf5, 0x00, 0xfd, 0x03, 0xff,
+  0x00, 0xf5, 0x00, 0x66, 0x01, 0x00, 0x00, 0xbd, 0x00, 0xf5, 0x13, 0xff,
+  0x00, 0xfb, 0x00, 0xe3, 0x00, 0x43, 0x00, 0x62, 0x00, 0xf2, 0x00, 0xfe,
+  0x02, 0xff, 0x00, 0xfb, 0x00, 0xd0, 0x00, 0x00, 0x00, 0x17, 0x00, 0xf2,
+  0x13, 0xff, 0x00, 0xfb, 0x00, 0xe7, 0x00, 0x33, 0x01, 0x00, 0x00, 0x77,
+  0x00, 0xfb, 0x03, 0xff, 0x00, 0xf4, 0x00, 0x2a, 0x00, 0x59, 0x00, 0xf5,
+  0x12, 0xff, 0x00, 0xfa, 0x00, 0xe8, 0x00, 0x36, 0x01, 0x00, 0x00, 0x10,
+  0x00, 0xcb, 0x00, 0xf7, 0x03, 0xff, 0x00, 0xf3, 0x00, 0x72, 0x00, 0x8e,
+  0x00, 0xf3, 0x11, 0xff, 0x00, 0xfc, 0x00, 0xee, 0x00, 0x37, 0x01, 0x00,
+  0x00, 0x10, 0x00, 0xc2, 0x00, 0xe8, 0x04, 0xff, 0x00, 0xf9, 0x00, 0xa3,
+  0x00, 0xad, 0x00, 0xfc, 0x05, 0xff, 0x00, 0xf5, 0x00, 0xf0, 0x00, 0xfe,
+  0x07, 0xff, 0x00, 0xfc, 0x00, 0xe9, 0x00, 0x39, 0x01, 0x00, 0x00, 0x0e,
+  0x00, 0xc2, 0x00, 0xea, 0x05, 0xff, 0x00, 0xf6, 0x00, 0xc9, 0x00, 0xc7,
+  0x00, 0xe9, 0x04, 0xff, 0x00, 0xef, 0x00, 0x9e, 0x00, 0x73, 0x00, 0xf5,
+  0x00, 0xfd, 0x05, 0xff, 0x00, 0xfb, 0x00, 0xec, 0x00, 0x3a, 0x01, 0x00,
+  0x00, 0x0e, 0x00, 0xc1, 0x00, 0xef, 0x07, 0xff, 0x00, 0xd7, 0x00, 0xc9,
+  0x00, 0xf0, 0x03, 0xff, 0x00, 0xf2, 0x00, 0xab, 0x01, 0x00, 0x00, 0x5f,
+  0x00, 0xf4, 0x00, 0xfe, 0x03, 0xff, 0x00, 0xfa, 0x00, 0xeb, 0x00, 0x3b,
+  0x01, 0x00, 0x00, 0x0d, 0x00, 0xc1, 0x00, 0xf3, 0x08, 0xff, 0x00, 0xdb,
+  0x00, 0xc5, 0x00, 0xee, 0x03, 0xff, 0x00, 0xf7, 0x00, 0xba, 0x00, 0x04,
+  0x01, 0x00, 0x00, 0x5b, 0x00, 0xf4, 0x00, 0xfc, 0x01, 0xff, 0x00, 0xfa,
+  0x00, 0xea, 0x00, 0x3c, 0x01, 0x00, 0x00, 0x0c, 0x00, 0xbe, 0x00, 0xfa,
+  0x09, 0xff, 0x00, 0xd3, 0x00, 0xa4, 0x00, 0xf8, 0x04, 0xff, 0x00, 0xfa,
+  0x00, 0xa5, 0x00, 0x04, 0x01, 0x00, 0x00, 0x58, 0x00, 0xf5, 0x00, 0xfd,
+  0x00, 0xfa, 0x00, 0xe9, 0x00, 0x3c, 0x01, 0x00, 0x00, 0x0b, 0x00, 0xbd,
+  0x00, 0xee, 0x09, 0xff, 0x00, 0xf6, 0x00, 0xc6, 0x00, 0x88, 0x00, 0xf6,
+  0x05, 0xff, 0x00, 0xf2, 0x00, 0xa0, 0x00, 0x01, 0x01, 0x00, 0x00, 0x57,
+  0x00, 0xf3, 0x00, 0xe8, 0x00, 0x3c, 0x01, 0x00, 0x00, 0x0b, 0x00, 0xbc,
+  0x00, 0xef, 0x0a, 0xff, 0x00, 0xf6, 0x00, 0x9b, 0x00, 0x53, 0x00, 0xf3,
+  0x06, 0xff, 0x00, 0xea, 0x00, 0x9b, 0x02, 0x00, 0x00, 0x37, 0x00, 0x2f,
+  0x01, 0x00, 0x00, 0x0a, 0x00, 0xbf, 0x00, 0xf4, 0x0b, 0xff, 0x00, 0xf7,
+  0x00, 0x63, 0x00, 0x14, 0x00, 0xf2, 0x07, 0xff, 0x00, 0xf3, 0x00, 0x97,
+  0x04, 0x00, 0x00, 0x0b, 0x00, 0xbc, 0x00, 0xf6, 0x0c, 0xff, 0x00, 0xf4,
+  0x00, 0x1f, 0x00, 0x00, 0x00, 0xb9, 0x00, 0xf4, 0x07, 0xff, 0x00, 0xed,
+  0x00, 0x96, 0x02, 0x00, 0x00, 0x0a, 0x00, 0xbc, 0x00, 0xf1, 0x0c, 0xff,
+  0x00, 0xf3, 0x00, 0xc6, 0x01, 0x00, 0x00, 0x5d, 0x00, 0xf7, 0x08, 0xff,
+  0x00, 0xeb, 0x00, 0x93, 0x00, 0x00, 0x00, 0x0a, 0x00, 0xbd, 0x00, 0xf1,
+  0x0d, 0xff, 0x00, 0xf6, 0x00, 0x69, 0x01, 0x00, 0x00, 0x09, 0x00, 0xe4,
+  0x00, 0xfc, 0x08, 0xff, 0x00, 0xe7, 0x00, 0xb2, 0x00, 0xc8, 0x00, 0xf3,
+  0x0d, 0xff, 0x00, 0xfd, 0x00, 0xe9, 0x00, 0x0d, 0x02, 0x00, 0x00, 0x7a,
+  0x00, 0xf7, 0x09, 0xff, 0x00, 0xfa, 0x00, 0xf5, 0x0e, 0xff, 0x00, 0xf0,
+  0x00, 0x87, 0x03, 0x00, 0x00, 0x0e, 0x00, 0xe4, 0x00, 0xfa, 0x18, 0xff,
+  0x00, 0xfa, 0x00, 0xeb, 0x00, 0x10, 0x04, 0x00, 0x00, 0x66, 0x00, 0xed,
+  0x18, 0xff, 0x00, 0xee, 0x00, 0x6f, 0x05, 0x00, 0x00, 0x01, 0x00, 0xc6,
+  0x00, 0xf4, 0x16, 0xff, 0x00, 0xf6, 0x00, 0xd3, 0x00, 0x05, 0x06, 0x00,
+  0x00, 0x32, 0x00, 0xed, 0x00, 0xfd, 0x15, 0xff, 0x00, 0xf5, 0x00, 0x3b,
+  0x08, 0x00, 0x00, 0x8a, 0x00, 0xf9, 0x14, 0xff, 0x00, 0xf7, 0x00, 0x9a,
+  0x09, 0x00, 0x00, 0x0a, 0x00, 0xda, 0x00, 0xf8, 0x12, 0xff, 0x00, 0xf9,
+  0x00, 0xe4, 0x00, 0x11, 0x0a, 0x00, 0x00, 0x42, 0x00, 0xf6, 0x00, 0xfe,
+  0x11, 0xff, 0x00, 0xf5, 0x00, 0x4f, 0x0c, 0x00, 0x00, 0x9a, 0x00, 0xf3,
+  0x10, 0xff, 0x00, 0xed, 0x00, 0xa8, 0x0d, 0x00, 0x00, 0x0f, 0x00, 0xde,
+  0x00, 0xf8, 0x0e, 0xff, 0x00, 0xf8, 0x00, 0xe4, 0x00, 0x13, 0x0e, 0x00,
+  0x00, 0x48, 0x00, 0xef, 0x0e, 0xff, 0x00, 0xf5, 0x00, 0x53, 0x10, 0x00,
+  0x00, 0x9c, 0x00, 0xec, 0x0c, 0xff, 0x00, 0xf7, 0x00, 0xab, 0x11, 0x00,
+  0x00, 0x0e, 0x00, 0xdc, 0x00, 0xf8, 0x0a, 0xff, 0x00, 0xfc, 0x00, 0xeb,
+  0x00, 0x1a, 0x12, 0x00, 0x00, 0x47, 0x00, 0xf2, 0x0a, 0xff, 0x00, 0xf2,
+  0x00, 0x5f, 0x14, 0x00, 0x00, 0x9e, 0x00, 0xf8, 0x08, 0xff, 0x00, 0xf7,
+  0x00, 0xb6, 0x15, 0x00, 0x00, 0x12, 0x00, 0xe0, 0x00, 0xf9, 0x06, 0xff,
+  0x00, 0xfb, 0x00, 0xe4, 0x00, 0x1e, 0x16, 0x00, 0x00, 0x51, 0x00, 0xf3,
+  0x06, 0xff, 0x00, 0xf4, 0x00, 0x67, 0x18, 0x00, 0x00, 0xad, 0x00, 0xed,
+  0x04, 0xff, 0x00, 0xf9, 0x00, 0xbe, 0x19, 0x00, 0x00, 0x1a, 0x00, 0xe8,
+  0x00, 0xfe, 0x02, 0xff, 0x00, 0xfd, 0x00, 0xef, 0x00, 0x26, 0x1a, 0x00,
+  0x00, 0x61, 0x00, 0xf6, 0x02, 0xff, 0x00, 0xf4, 0x00, 0x74, 0x1c, 0x00,
+  0x00, 0xbc, 0x00, 0xf8, 0x00, 0xff, 0x00, 0xf6, 0x00, 0xc5, 0x00, 0x02,
+  0x1c, 0x00, 0x00, 0x23, 0x00, 0xec, 0x00, 0xf5, 0x00, 0xec, 0x00, 0x27,
+  0x1e, 0x00, 0x00, 0x71, 0x00, 0xf4, 0x00, 0x73, 0x1f, 0x00, 0x00, 0x01,
+  0x00, 0x73, 0x00, 0x01, 0x0f, 0x00,
+};
+unsigned int const pin_green_r5z_len = 1638;
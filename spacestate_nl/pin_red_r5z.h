@@ -0,0 +1,153 @@
+// Generated by tools/r5zenc, do not edit
+unsigned char const pin_red_r5z[] = {
+  0x52, 0x35, 0x5a, 0x31, 0x23, 0x00, 0x32, 0x00, 0xa7, 0x02, 0x00, 0x00,
+  0xf9, 0x06, 0x00, 0x00, 0xcd, 0xfe, 0xd2, 0xf4, 0x6f, 0xa2, 0x87, 0xa2,
+  0x79, 0x2f, 0x51, 0x6f, 0x8f, 0xd8, 0xd6, 0xa5, 0x88, 0x2f, 0x6b, 0x5a,
+  0x51, 0x41, 0x5a, 0xc1, 0x75, 0xa3, 0x88, 0x27, 0xa2, 0x88, 0x2f, 0x96,
+  0xb9, 0xd1, 0xa3, 0x88, 0x36, 0xc0, 0x08, 0x9c, 0x78, 0x41, 0xc7, 0xa2,
+  0x88, 0x08, 0xa4, 0x97, 0x36, 0x9b, 0x87, 0xce, 0x27, 0x36, 0x08, 0x06,
+  0xcd, 0xa5, 0xa9, 0x2f, 0x62, 0xcc, 0x36, 0x27, 0x98, 0x59, 0x06, 0xcf,
+  0x15, 0x1f, 0x2f, 0x91, 0xb8, 0xc9, 0xae, 0x58, 0x1f, 0x06, 0xd3, 0xa6,
+  0xb8, 0x3b, 0x8e, 0xf8, 0xc7, 0x2f, 0x1f, 0x06, 0xd5, 0x0b, 0x36, 0xc6,
+  0x2a, 0x5a, 0x06, 0xd7, 0x1f, 0x2a, 0xc4, 0x99, 0xb7, 0x3b, 0x1a, 0x06,
+  0xd7, 0x6f, 0x33, 0x22, 0xc3, 0x36, 0x3c, 0x06, 0xd9, 0xa3, 0xa9, 0x3b,
+  0xc2, 0x97, 0xb7, 0x36, 0x06, 0xc5, 0x1d, 0x7e, 0x06, 0xc9, 0x1a, 0x2c,
+  0x06, 0xc5, 0xa9, 0xb8, 0x27, 0xc1, 0x2f, 0x08, 0x06, 0xc4, 0xa5, 0xa8,
+  0x3b, 0xc0, 0x08, 0x06, 0xc7, 0xa4, 0x98, 0x3b, 0xc0, 0x1f, 0x06, 0xc4,
+  0x2c, 0x36, 0xc1, 0x3b, 0x1a, 0x06, 0xc4, 0x27, 0x96, 0xd8, 0xc0, 0x2f,
+  0x08, 0x06, 0xc5, 0x2c, 0x3b, 0x2f, 0xc0, 0x36, 0x99, 0x47, 0x06, 0xc4,
+  0x3b, 0x11, 0xa4, 0x87, 0x33, 0x06, 0xc5, 0x08, 0x2f, 0xc1, 0x2a, 0x08,
+  0x06, 0xc3, 0x2c, 0x3b, 0x2f, 0xc0, 0x3b, 0x33, 0x06, 0xc5, 0xa7, 0xb8,
+  0x27, 0x2f, 0x10, 0x06, 0xc6, 0x10, 0x2f, 0xc1, 0x2a, 0x08, 0x06, 0xc1,
+  0x2c, 0x3b, 0x9d, 0x88, 0xc0, 0x3b, 0x33, 0x97, 0x48, 0x06, 0xc5, 0x39,
+  0x36, 0x2f, 0x08, 0x06, 0xc7, 0x10, 0x36, 0xc2, 0x0b, 0x06, 0x2c, 0x36,
+  0x2a, 0xc0, 0x36, 0x33, 0x12, 0x06, 0xc6, 0xa3, 0x99, 0xa9, 0xb7, 0x07,
+  0x39, 0x06, 0xc8, 0x10, 0x36, 0xc2, 0x1f, 0x3b, 0x9d, 0x87, 0xc0, 0x3b,
+  0x24, 0x12, 0x06, 0xc7, 0x7a, 0x2f, 0x5a, 0x99, 0x79, 0x06, 0xc9, 0x10,
+  0x36, 0xc1, 0x3b, 0x9d, 0x98, 0xc0, 0x3b, 0x24, 0x12, 0x06, 0xc9, 0xaa,
+  0xc7, 0x00, 0x98, 0x79, 0x06, 0xca, 0xa8, 0xa8, 0x3b, 0xc2, 0x00, 0x24,
+  0x12, 0x06, 0xc9, 0x09, 0x2a, 0x3b, 0x05, 0x06, 0xca, 0x31, 0x3b, 0xc2,
+  0x36, 0x08, 0x06, 0xca, 0x29, 0x3b, 0x2a, 0x10, 0x06, 0xc9, 0x29, 0x3b,
+  0x9d, 0x97, 0xc2, 0x92, 0xd7, 0x3b, 0x39, 0x06, 0xc9, 0x34, 0x36, 0x97,
+  0xa6, 0x27, 0x06, 0xc8, 0x29, 0x3b, 0x9b, 0x98, 0xc0, 0x1e, 0x3b, 0x2a,
+  0xc0, 0x91, 0xd7, 0x3b, 0x39, 0x06, 0xc8, 0x10, 0x2a, 0xc0, 0x3b, 0x06,
+  0xc7, 0x29, 0x3b, 0x25, 0xc0, 0x1e, 0x27, 0x15, 0x1f, 0x36, 0xc0, 0x32,
+  0x3b, 0x9a, 0x69, 0x06, 0xc7, 0x27, 0x99, 0xa7, 0xc0, 0x3b, 0x39, 0x06,
+  0xc5, 0xa3, 0x98, 0x36, 0x9c, 0xa8, 0xc0, 0x1b, 0x27, 0x15, 0x06, 0xc0,
+  0x1f, 0x2f, 0xc0, 0x21, 0xb2, 0x18, 0x39, 0x06, 0xc5, 0x15, 0x3b, 0xc1,
+  0x9b, 0x97, 0x24, 0x06, 0xc4, 0x1d, 0x36, 0x16, 0xc0, 0x1b, 0x27, 0x99,
+  0x48, 0x06, 0xc2, 0x24, 0x2f, 0xc0, 0x93, 0xd7, 0x3b, 0x39, 0x06, 0xc4,
+  0x08, 0x2f, 0xc2, 0x36, 0x1d, 0x06, 0xc3, 0x24, 0x16, 0xc0, 0x2a, 0x33,
+  0x1a, 0x06, 0xc4, 0x1f, 0x36, 0xc0, 0x21, 0x00, 0x15, 0x06, 0xc2, 0x6e,
+  0x36, 0x97, 0xa7, 0xc2, 0x2a, 0x45, 0x06, 0xc3, 0x10, 0x2a, 0x1b, 0x33,
+  0x1a, 0x06, 0xc6, 0x1c, 0x3b, 0x2a, 0x33, 0x06, 0xc3, 0x08, 0x36, 0xc5,
+  0x22, 0x06, 0xc3, 0xa7, 0xa8, 0x1f, 0x1a, 0x06, 0xc8, 0x0d, 0x1f, 0x1a,
+  0x06, 0xc2, 0x12, 0x36, 0x16, 0xc4, 0x27, 0xc0, 0x06, 0xd7, 0xa6, 0xb8,
+  0x36, 0xc6, 0x2f, 0x39, 0x06, 0xd5, 0x1a, 0x36, 0x91, 0xe7, 0xc6, 0x16,
+  0x2c, 0x12, 0x06, 0xd4, 0x1f, 0xa0, 0xa8, 0xc8, 0x2a, 0x10, 0x06, 0xd3,
+  0x34, 0x36, 0xca, 0x3b, 0x98, 0x68, 0x06, 0xd1, 0x12, 0x36, 0x16, 0xca,
+  0x7a, 0x2c, 0x12, 0x06, 0xd0, 0x10, 0x2f, 0xcc, 0x2a, 0x10, 0x06, 0xcf,
+  0x25, 0x36, 0x8c, 0xe7, 0xcc, 0xa6, 0x68, 0x36, 0x22, 0x06, 0xce, 0x27,
+  0x16, 0xce, 0x1e, 0x2c, 0x06, 0xcd, 0x08, 0x2a, 0xd0, 0x6e, 0x08, 0x06,
+  0xcb, 0x1d, 0x36, 0x32, 0xd0, 0x51, 0x2f, 0x1d, 0x06, 0xca, 0x27, 0x2a,
+  0xd2, 0x1b, 0x24, 0x06, 0xc9, 0x3c, 0x36, 0xd4, 0x2f, 0x9b, 0x58, 0x06,
+  0xc7, 0x15, 0x36, 0x97, 0xb7, 0xd4, 0x28, 0x36, 0x15, 0x06, 0xc6, 0x1f,
+  0x1b, 0xd6, 0x7a, 0x1f, 0x06, 0xc5, 0x34, 0x2f, 0xd8, 0x36, 0x34, 0x06,
+  0xc3, 0x12, 0x2f, 0x16, 0xd8, 0x18, 0x2c, 0x12, 0x06, 0xc2, 0x1f, 0x2a,
+  0xdb, 0x10, 0x06, 0xc1, 0xa3, 0xa9, 0x3b, 0xdc, 0x36, 0x2c, 0x06, 0x12,
+  0xa9, 0xc7, 0x16, 0xdc, 0x0a, 0x2c, 0x06, 0x10, 0x2f, 0xde, 0x2a, 0x1f,
+  0x36, 0x8d, 0xd7, 0xdf, 0x36, 0x2a, 0xcf, 0x0d, 0x00, 0x00, 0x25, 0x00,
+  0x4b, 0x00, 0x64, 0x01, 0x65, 0x00, 0x53, 0x00, 0x31, 0x00, 0x06, 0x16,
+  0x00, 0x00, 0x0a, 0x00, 0x57, 0x00, 0xae, 0x00, 0xe8, 0x00, 0xf6, 0x00,
+  0xf7, 0x00, 0xf1, 0x00, 0xfe, 0x00, 0xfd, 0x00, 0xf2, 0x00, 0xf5, 0x00,
+  0xf1, 0x00, 0xb7, 0x00, 0x65, 0x00, 0x0d, 0x11, 0x00, 0x00, 0x09, 0x00,
+  0x79, 0x00, 0xe2, 0x00, 0xf8, 0x00, 0xf6, 0x00, 0xfe, 0x07, 0xff, 0x00,
+  0xf6, 0x00, 0xf5, 0x00, 0xeb, 0x00, 0x81, 0x00, 0x0f, 0x0e, 0x00, 0x00,
+  0x45, 0x00, 0xd8, 0x00, 0xf1, 0x00, 0xf9, 0x0c, 0xff, 0x00, 0xf9, 0x00,
+  0xf3, 0x00, 0xe5, 0x00, 0x51, 0x0c, 0x00, 0x00, 0x78, 0x00, 0xf2, 0x00,
+  0xf9, 0x10, 0xff, 0x00, 0xfc, 0x00, 0xf7, 0x00, 0x8c, 0x00, 0x01, 0x09,
+  0x00, 0x00, 0x8c, 0x00, 0xed, 0x00, 0xfd, 0x12, 0xff, 0x00, 0xfb, 0x00,
+  0xf8, 0x00, 0xa8, 0x00, 0x04, 0x07, 0x00, 0x00, 0x76, 0x00, 0xf0, 0x00,
+  0xf9, 0x15, 0xff, 0x00, 0xf5, 0x00, 0x9a, 0x06, 0x00, 0x00, 0x3f, 0x00,
+  0xf8, 0x00, 0xfd, 0x17, 0xff, 0x00, 0xf4, 0x00, 0x6b, 0x04, 0x00, 0x00,
+  0x0a, 0x00, 0xda, 0x00, 0xfa, 0x18, 0xff, 0x00, 0xf8, 0x00, 0xef, 0x00,
+  0x26, 0x03, 0x00, 0x00, 0x7c, 0x00, 0xf4, 0x1a, 0xff, 0x00, 0xf5, 0x00,
+  0xb2, 0x02, 0x00, 0x00, 0x0d, 0x00, 0xe4, 0x00, 0xfc, 0x05, 0xff, 0x00,
+  0xfa, 0x00, 0xf5, 0x0a, 0xff, 0x00, 0xf9, 0x00, 0xf7, 0x00, 0xfe, 0x05,
+  0xff, 0x00, 0xf7, 0x00, 0x34, 0x01, 0x00, 0x00, 0x66, 0x00, 0xf9, 0x05,
+  0xff, 0x00, 0xf4, 0x00, 0xb3, 0x00, 0x9c, 0x00, 0xef, 0x08, 0xff, 0x00,
+  0xfc, 0x00, 0xca, 0x00, 0x81, 0x00, 0xf2, 0x00, 0xfd, 0x04, 0xff, 0x00,
+  0xf5, 0x00, 0x9f, 0x01, 0x00, 0x00, 0xbb, 0x00, 0xf6, 0x05, 0xff, 0x00,
+  0xf4, 0x00, 0x07, 0x00, 0x00, 0x00, 0x8b, 0x00, 0xeb, 0x06, 0xff, 0x00,
+  0xfd, 0x00, 0xc8, 0x00, 0x0f, 0x00, 0x00, 0x00, 0xa1, 0x00, 0xfc, 0x04,
+  0xff, 0x00, 0xfc, 0x00, 0xe7, 0x00, 0x06, 0x00, 0x0a, 0x00, 0xf4, 0x00,
+  0xfe, 0x05, 0xff, 0x00, 0xf5, 0x00, 0x83, 0x01, 0x00, 0x00, 0x8c, 0x00,
+  0xec, 0x04, 0xff, 0x00, 0xfd, 0x00, 0xc7, 0x00, 0x10, 0x00, 0x00, 0x00,
+  0x43, 0x00, 0xec, 0x00, 0xfc, 0x05, 0xff, 0x00, 0xf8, 0x00, 0x44, 0x00,
+  0x38, 0x00, 0xf6, 0x07, 0xff, 0x00, 0xf9, 0x00, 0x82, 0x01, 0x00, 0x00,
+  0x8b, 0x00, 0xf4, 0x02, 0xff, 0x00, 0xfd, 0x00, 0xc8, 0x00, 0x0f, 0x00,
+  0x00, 0x00, 0x45, 0x00, 0xe8, 0x00, 0xf8, 0x06, 0xff, 0x00, 0xf4, 0x00,
+  0x7b, 0x00, 0x61, 0x00, 0xf3, 0x08, 0xff, 0x00, 0xf9, 0x00, 0x7f, 0x01,
+  0x00, 0x00, 0x84, 0x00, 0xf9, 0x00, 0xff, 0x00, 0xf9, 0x00, 0xc7, 0x00,
+  0x0f, 0x00, 0x00, 0x00, 0x44, 0x00, 0xe6, 0x00, 0xf5, 0x07, 0xff, 0x00,
+  0xfc, 0x00, 0x9f, 0x00, 0x70, 0x00, 0xfe, 0x09, 0xff, 0x00, 0xf9, 0x00,
+  0x7e, 0x01, 0x00, 0x00, 0x7f, 0x00, 0xf9, 0x00, 0xc8, 0x00, 0x10, 0x00,
+  0x00, 0x00, 0x44, 0x00, 0xf2, 0x00, 0xf4, 0x08, 0xff, 0x00, 0xf7, 0x00,
+  0xbb, 0x00, 0x81, 0x00, 0xfc, 0x0a, 0xff, 0x00, 0xfb, 0x00, 0x7c, 0x01,
+  0x00, 0x00, 0x50, 0x00, 0x11, 0x00, 0x00, 0x00, 0x45, 0x00, 0xf3, 0x00,
+  0xfe, 0x09, 0xff, 0x00, 0xf2, 0x00, 0xc9, 0x00, 0x77, 0x00, 0xfd, 0x0b,
+  0xff, 0x00, 0xfa, 0x00, 0x7a, 0x02, 0x00, 0x00, 0x47, 0x00, 0xf1, 0x00,
+  0xfd, 0x0a, 0xff, 0x00, 0xf9, 0x00, 0xc0, 0x00, 0x65, 0x00, 0xf3, 0x0b,
+  0xff, 0x00, 0xf3, 0x00, 0xc7, 0x02, 0x00, 0x00, 0x8d, 0x00, 0xf9, 0x0b,
+  0xff, 0x00, 0xfb, 0x00, 0xa2, 0x00, 0x44, 0x00, 0xf8, 0x0a, 0xff, 0x00,
+  0xfd, 0x00, 0xcc, 0x00, 0x13, 0x02, 0x00, 0x00, 0x01, 0x00, 0x9d, 0x00,
+  0xfb, 0x0a, 0xff, 0x00, 0xf6, 0x00, 0x83, 0x00, 0x15, 0x00, 0xf5, 0x09,
+  0xff, 0x00, 0xfe, 0x00, 0xcd, 0x00, 0x13, 0x00, 0x00, 0x00, 0x36, 0x00,
+  0xde, 0x00, 0x64, 0x00, 0x00, 0x00, 0x01, 0x00, 0x9a, 0x00, 0xfa, 0x09,
+  0xff, 0x00, 0xf7, 0x00, 0x51, 0x00, 0x00, 0x00, 0xd2, 0x00, 0xfa, 0x07,
+  0xff, 0x00, 0xfd, 0x00, 0xcd, 0x00, 0x14, 0x00, 0x00, 0x00, 0x33, 0x00,
+  0xeb, 0x00, 0xf8, 0x00, 0xed, 0x00, 0x64, 0x00, 0x00, 0x00, 0x01, 0x00,
+  0x9b, 0x00, 0xfc, 0x08, 0xff, 0x00, 0xf5, 0x00, 0x13, 0x00, 0x00, 0x00,
+  0x82, 0x00, 0xfa, 0x06, 0xff, 0x00, 0xfd, 0x00, 0xcf, 0x00, 0x15, 0x00,
+  0x00, 0x00, 0x33, 0x00, 0xe8, 0x00, 0xfd, 0x00, 0xff, 0x00, 0xfa, 0x00,
+  0xeb, 0x00, 0x65, 0x00, 0x00, 0x00, 0x01, 0x00, 0x9f, 0x00, 0xfc, 0x06,
+  0xff, 0x00, 0xf4, 0x00, 0xbe, 0x01, 0x00, 0x00, 0x28, 0x00, 0xf8, 0x05,
+  0xff, 0x00, 0xfb, 0x00, 0xce, 0x00, 0x15, 0x00, 0x00, 0x00, 0x31, 0x00,
+  0xe8, 0x00, 0xf9, 0x02, 0xff, 0x00, 0xfa, 0x00, 0xe7, 0x00, 0x66, 0x00,
+  0x00, 0x00, 0x02, 0x00, 0xa1, 0x00, 0xfc, 0x05, 0xff, 0x00, 0xf6, 0x00,
+  0x65, 0x02, 0x00, 0x00, 0xbc, 0x00, 0xf7, 0x04, 0xff, 0x00, 0xf6, 0x00,
+  0x16, 0x00, 0x00, 0x00, 0x2e, 0x00, 0xe7, 0x00, 0xfa, 0x04, 0xff, 0x00,
+  0xfa, 0x00, 0xec, 0x00, 0x65, 0x00, 0x00, 0x00, 0x03, 0x00, 0xbd, 0x00,
+  0xf9, 0x03, 0xff, 0x00, 0xfd, 0x00, 0xe7, 0x00, 0x0c, 0x02, 0x00, 0x00,
+  0x41, 0x00, 0xf8, 0x04, 0xff, 0x00, 0xf4, 0x00, 0x6c, 0x00, 0x30, 0x00,
+  0xe5, 0x00, 0xfa, 0x07, 0xff, 0x00, 0xf0, 0x00, 0x6d, 0x00, 0x2b, 0x00,
+  0xdc, 0x00, 0xfc, 0x03, 0xff, 0x00, 0xf2, 0x00, 0x80, 0x04, 0x00, 0x00,
+  0xc1, 0x00, 0xf8, 0x03, 0xff, 0x00, 0xfe, 0x00, 0xef, 0x00, 0xf6, 0x00,
+  0xf9, 0x09, 0xff, 0x00, 0xf7, 0x00, 0xf8, 0x00, 0xf9, 0x03, 0xff, 0x00,
+  0xfb, 0x00, 0xeb, 0x00, 0x0f, 0x04, 0x00, 0x00, 0x37, 0x00, 0xf7, 0x00,
+  0xfd, 0x17, 0xff, 0x00, 0xf6, 0x00, 0x70, 0x06, 0x00, 0x00, 0x9c, 0x00,
+  0xf3, 0x16, 0xff, 0x00, 0xf3, 0x00, 0xd1, 0x00, 0x06, 0x06, 0x00, 0x00,
+  0x14, 0x00, 0xe8, 0x00, 0xfd, 0x15, 0xff, 0x00, 0xf5, 0x00, 0x44, 0x08,
+  0x00, 0x00, 0x61, 0x00, 0xf3, 0x14, 0xff, 0x00, 0xfa, 0x00, 0xa5, 0x0a,
+  0x00, 0x00, 0xb9, 0x00, 0xf8, 0x12, 0xff, 0x00, 0xf9, 0x00, 0xe6, 0x00,
+  0x16, 0x0a, 0x00, 0x00, 0x22, 0x00, 0xec, 0x00, 0xfb, 0x11, 0xff, 0x00,
+  0xfa, 0x00, 0x64, 0x0c, 0x00, 0x00, 0x73, 0x00, 0xef, 0x10, 0xff, 0x00,
+  0xf5, 0x00, 0xc4, 0x00, 0x01, 0x0c, 0x00, 0x00, 0x02, 0x00, 0xc4, 0x00,
+  0xf4, 0x0f, 0xff, 0x00, 0xf3, 0x00, 0x28, 0x0e, 0x00, 0x00, 0x2b, 0x00,
+  0xe9, 0x00, 0xfc, 0x0d, 0xff, 0x00, 0xf6, 0x00, 0x7c, 0x10, 0x00, 0x00,
+  0x81, 0x00, 0xf3, 0x0c, 0xff, 0x00, 0xf7, 0x00, 0xce, 0x00, 0x04, 0x10,
+  0x00, 0x00, 0x06, 0x00, 0xcf, 0x00, 0xfb, 0x0a, 0xff, 0x00, 0xfb, 0x00,
+  0xf1, 0x00, 0x33, 0x12, 0x00, 0x00, 0x38, 0x00, 0xf4, 0x00, 0xfd, 0x09,
+  0xff, 0x00, 0xf7, 0x00, 0x8f, 0x14, 0x00, 0x00, 0x8e, 0x00, 0xfa, 0x08,
+  0xff, 0x00, 0xf9, 0x00, 0xd7, 0x00, 0x0b, 0x14, 0x00, 0x00, 0x0b, 0x00,
+  0xd9, 0x00, 0xf8, 0x07, 0xff, 0x00, 0xfa, 0x00, 0x49, 0x16, 0x00, 0x00,
+  0x47, 0x00, 0xf6, 0x06, 0xff, 0x00, 0xf7, 0x00, 0xa4, 0x18, 0x00, 0x00,
+  0x9d, 0x00, 0xef, 0x04, 0xff, 0x00, 0xf9, 0x00, 0xe7, 0x00, 0x13, 0x18,
+  0x00, 0x00, 0x15, 0x00, 0xe9, 0x00, 0xfc, 0x03, 0xff, 0x00, 0xf4, 0x00,
+  0x57, 0x1a, 0x00, 0x00, 0x5d, 0x00, 0xf4, 0x02, 0xff, 0x00, 0xf3, 0x00,
+  0xb1, 0x1c, 0x00, 0x00, 0xb8, 0x00, 0xf9, 0x00, 0xff, 0x00, 0xfe, 0x00,
+  0xeb, 0x00, 0x1d, 0x1c, 0x00, 0x00, 0x20, 0x00, 0xec, 0x00, 0xfd, 0x00,
+  0xf3, 0x00, 0x6b, 0x1e, 0x00, 0x00, 0x6d, 0x00, 0xf8, 0x00, 0xc6, 0x00,
+  0x01, 0x1f, 0x00, 0x00, 0xa5, 0x00, 0x28, 0x0f, 0x00,
+};
+unsigned int const pin_red_r5z_len = 1785;
@@ -0,0 +1,614 @@
+//
+// Streaming PNG decoder.
+//
+// Inflates and unfilters one scanline at a time and hands each row, expanded to RGBA8888, to a callback that writes
+// it wherever it belongs (normally straight into an RGB565 framebuffer). Peak memory is the 32 KB inflate window
+// plus a few scanlines, instead of a full decoded copy of the image.
+//
+// With `threaded` set and more than one core, inflate+unfilter run on a worker thread that keeps PNG_PIPE_ROWS rows
+// ahead of the caller, which expands and converts them: the two stages overlap.
+//
+//     png_stream_decode(io, my_row_fn, &target, true);
+//
+// Supported: every color type at every bit depth the spec allows for it (16-bit samples are cut to their top byte),
+// palette transparency. Other depths are PNG_ERR_FORMAT.
+// Not supported: Adam7 interlacing (PNG_ERR_UNSUPPORTED), so callers keep a fallback for those.
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#define PNG_PIPE_ROWS  8
+#define PNG_FAST_BITS  10 // Huffman codes up to this long decode with one table lookup
+#define PNG_WINDOW     32768
+#define PNG_INPUT_SIZE 1024
+
+typedef enum {
+    PNG_OK,
+    PNG_ERR_IO,
+    PNG_ERR_FORMAT,
+    PNG_ERR_UNSUPPORTED,
+    PNG_ERR_MEMORY,
+} png_result_t;
+
+// Called once per row, top to bottom. `rgba` holds `width` pixels and is only valid during the call.
+typedef void (*png_row_fn)(void *userdata, int y, Uint8 const *rgba, int width);
+
+typedef struct {
+    Uint16 count[16];
+    Uint16 symbol[288];
+    Uint16 fast[1 << PNG_FAST_BITS]; // (length << 9) | symbol, 0 when the code is longer than PNG_FAST_BITS
+} png_huffman_t;
+
+typedef struct {
+    SDL_IOStream *io;
+
+    // Header
+    int width;
+    int height;
+    int depth;
+    int color_type;
+    int channels;
+    int filter_bpp;  // bytes per complete pixel, at least 1
+    int row_bytes;   // without the filter byte
+    Uint8 palette[256][4];
+
+    // IDAT byte source
+    Uint32 chunk_left;
+    Uint8 input[PNG_INPUT_SIZE];
+    int input_pos;
+    int input_len;
+    Uint32 bits;
+    int bit_count;
+    bool input_end;
+    int overrun; // zero bytes handed out past the end of the data
+
+    // Inflate
+    enum { PNG_BLOCK_HEADER, PNG_BLOCK_STORED, PNG_BLOCK_HUFFMAN, PNG_BLOCK_DONE } block;
+    bool final_block;
+    Uint32 stored_left;
+    int match_len;
+    int match_dist;
+    Uint32 total_out;
+    png_huffman_t lit;
+    png_huffman_t dist;
+    Uint8 window[PNG_WINDOW];
+
+    // Scanlines: a ring of raw (unfiltered) rows, each with its filter byte in front
+    Uint8 *rows;
+    Uint8 *rgba;
+    png_result_t status;
+
+    // Pipeline
+    SDL_Semaphore *free_rows;
+    SDL_Semaphore *full_rows;
+} png_stream_t;
+
+static inline Uint32 png_be32_(Uint8 const *p) {
+    return ((Uint32) p[0] << 24) | ((Uint32) p[1] << 16) | ((Uint32) p[2] << 8) | p[3];
+}
+
+static inline bool png_read_(png_stream_t *s, void *dst, size_t size) {
+    return SDL_ReadIO(s->io, dst, size) == size;
+}
+
+// Next compressed byte, following the data across IDAT chunks. Past the end it returns zeros and flags input_end.
+static inline Uint8 png_next_byte_(png_stream_t *s) {
+    if (s->input_pos < s->input_len) {
+        return s->input[s->input_pos++];
+    }
+    while (s->chunk_left == 0 && !s->input_end) {
+        Uint8 header[12]; // CRC of the previous chunk, then length and type of the next one
+        if (!png_read_(s, header, sizeof(header)) || SDL_memcmp(&header[8], "IDAT", 4) != 0) {
+            s->input_end = true;
+            s->overrun++;
+            return 0;
+        }
+        s->chunk_left = png_be32_(&header[4]);
+    }
+    if (s->input_end) {
+        s->overrun++;
+        return 0;
+    }
+    const size_t want = SDL_min(s->chunk_left, (Uint32) sizeof(s->input));
+    const size_t got = SDL_ReadIO(s->io, s->input, want);
+    if (got == 0) {
+        s->input_end = true;
+        s->overrun++;
+        return 0;
+    }
+    s->chunk_left -= (Uint32) got;
+    s->input_len = (int) got;
+    s->input_pos = 1;
+    return s->input[0];
+}
+
+static inline void png_need_bits_(png_stream_t *s, int n) {
+    while (s->bit_count < n) {
+        s->bits |= (Uint32) png_next_byte_(s) << s->bit_count;
+        s->bit_count += 8;
+    }
+}
+
+static inline int png_get_bits_(png_stream_t *s, int n) {
+    png_need_bits_(s, n);
+    const int value = (int) (s->bits & ((1u << n) - 1));
+    s->bits >>= n;
+    s->bit_count -= n;
+    return value;
+}
+
+// Canonical Huffman table from code lengths. Returns false for an over-subscribed set.
+static inline bool png_build_huffman_(png_huffman_t *h, Uint8 const *lengths, int n) {
+    SDL_memset(h->count, 0, sizeof(h->count));
+    SDL_memset(h->fast, 0, sizeof(h->fast));
+    for (int i = 0; i < n; i++) {
+        h->count[lengths[i]]++;
+    }
+    h->count[0] = 0;
+
+    int left = 1;
+    Uint16 offsets[16];
+    offsets[1] = 0;
+    for (int len = 1; len < 16; len++) {
+        left = (left << 1) - h->count[len];
+        if (left < 0) {
+            return false;
+        }
+        if (len < 15) {
+            offsets[len + 1] = offsets[len] + h->count[len];
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (lengths[i]) {
+            h->symbol[offsets[lengths[i]]++] = (Uint16) i;
+        }
+    }
+
+    // Short codes also go in the lookup table, indexed by their bits as they arrive (reversed)
+    int code = 0;
+    int index = 0;
+    for (int len = 1; len <= PNG_FAST_BITS; len++) {
+        for (int i = 0; i < h->count[len]; i++, code++, index++) {
+            int reversed = 0;
+            for (int b = 0; b < len; b++) {
+                reversed |= ((code >> b) & 1) << (len - 1 - b);
+            }
+            for (int fill = reversed; fill < (1 << PNG_FAST_BITS); fill += 1 << len) {
+                h->fast[fill] = (Uint16) ((len << 9) | h->symbol[index]);
+            }
+        }
+        code <<= 1;
+    }
+    return true;
+}
+
+static inline int png_decode_symbol_(png_stream_t *s, png_huffman_t const *h) {
+    png_need_bits_(s, 15);
+    const Uint16 entry = h->fast[s->bits & ((1u << PNG_FAST_BITS) - 1)];
+    if (entry) {
+        s->bits >>= entry >> 9;
+        s->bit_count -= entry >> 9;
+        return entry & 0x1FF;
+    }
+    // Long code: walk the canonical code lengths one bit at a time
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len < 16; len++) {
+        code |= png_get_bits_(s, 1);
+        const int count = h->count[len];
+        if (code - count < first) {
+            return h->symbol[index + (code - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static inline bool png_fixed_tables_(png_stream_t *s) {
+    Uint8 lengths[288];
+    for (int i = 0; i < 288; i++) {
+        lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+    }
+    Uint8 dist_lengths[30];
+    SDL_memset(dist_lengths, 5, sizeof(dist_lengths));
+    return png_build_huffman_(&s->lit, lengths, 288) && png_build_huffman_(&s->dist, dist_lengths, 30);
+}
+
+static inline bool png_dynamic_tables_(png_stream_t *s) {
+    static const Uint8 order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    const int nlen = png_get_bits_(s, 5) + 257;
+    const int ndist = png_get_bits_(s, 5) + 1;
+    const int ncode = png_get_bits_(s, 4) + 4;
+    if (nlen > 286 || ndist > 30) {
+        return false;
+    }
+
+    Uint8 lengths[286 + 30];
+    SDL_memset(lengths, 0, 19);
+    for (int i = 0; i < ncode; i++) {
+        lengths[order[i]] = (Uint8) png_get_bits_(s, 3);
+    }
+    if (!png_build_huffman_(&s->lit, lengths, 19)) {
+        return false;
+    }
+
+    for (int i = 0; i < nlen + ndist;) {
+        int symbol = png_decode_symbol_(s, &s->lit);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[i++] = (Uint8) symbol;
+            continue;
+        }
+        Uint8 repeat_value = 0;
+        int repeat;
+        if (symbol == 16) {
+            if (i == 0) {
+                return false;
+            }
+            repeat_value = lengths[i - 1];
+            repeat = 3 + png_get_bits_(s, 2);
+        } else if (symbol == 17) {
+            repeat = 3 + png_get_bits_(s, 3);
+        } else {
+            repeat = 11 + png_get_bits_(s, 7);
+        }
+        if (i + repeat > nlen + ndist) {
+            return false;
+        }
+        while (repeat--) {
+            lengths[i++] = repeat_value;
+        }
+    }
+    return png_build_huffman_(&s->lit, lengths, nlen) && png_build_huffman_(&s->dist, &lengths[nlen], ndist);
+}
+
+static inline void png_put_(png_stream_t *s, Uint8 *out, int *produced, Uint8 byte) {
+    out[(*produced)++] = byte;
+    s->window[s->total_out++ & (PNG_WINDOW - 1)] = byte;
+}
+
+// Inflate exactly `n` bytes into `out`, resuming wherever the last call stopped. Returns false on corrupt or
+// truncated data.
+static inline bool png_inflate_(png_stream_t *s, Uint8 *out, int n) {
+    static const Uint16 len_base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+                                        67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const Uint8 len_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                        4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const Uint16 dist_base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+                                         513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const Uint8 dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8,
+                                         9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    int produced = 0;
+    while (produced < n) {
+        if (s->overrun > 4) { // the bit buffer may read a little ahead, more than that is a truncated stream
+            return false;
+        }
+        if (s->match_len > 0) {
+            const Uint8 byte = s->window[(s->total_out - s->match_dist) & (PNG_WINDOW - 1)];
+            png_put_(s, out, &produced, byte);
+            s->match_len--;
+            continue;
+        }
+        switch (s->block) {
+            case PNG_BLOCK_HEADER: {
+                s->final_block = png_get_bits_(s, 1);
+                const int type = png_get_bits_(s, 2);
+                if (type == 0) {
+                    png_get_bits_(s, s->bit_count & 7); // to the byte boundary
+                    const int len = png_get_bits_(s, 16);
+                    const int nlen = png_get_bits_(s, 16);
+                    if ((len ^ 0xFFFF) != nlen) {
+                        return false;
+                    }
+                    s->stored_left = (Uint32) len;
+                    s->block = PNG_BLOCK_STORED;
+                } else if ((type == 1 && png_fixed_tables_(s)) || (type == 2 && png_dynamic_tables_(s))) {
+                    s->block = PNG_BLOCK_HUFFMAN;
+                } else {
+                    return false;
+                }
+                break;
+            }
+            case PNG_BLOCK_STORED:
+                if (s->stored_left == 0) {
+                    s->block = s->final_block ? PNG_BLOCK_DONE : PNG_BLOCK_HEADER;
+                    break;
+                }
+                png_put_(s, out, &produced, (Uint8) png_get_bits_(s, 8));
+                s->stored_left--;
+                break;
+            case PNG_BLOCK_HUFFMAN: {
+                const int symbol = png_decode_symbol_(s, &s->lit);
+                if (symbol < 0 || symbol > 285) {
+                    return false;
+                }
+                if (symbol < 256) {
+                    png_put_(s, out, &produced, (Uint8) symbol);
+                } else if (symbol == 256) {
+                    s->block = s->final_block ? PNG_BLOCK_DONE : PNG_BLOCK_HEADER;
+                } else {
+                    const int len_symbol = symbol - 257;
+                    s->match_len = len_base[len_symbol] + png_get_bits_(s, len_extra[len_symbol]);
+                    const int dist_symbol = png_decode_symbol_(s, &s->dist);
+                    if (dist_symbol < 0 || dist_symbol > 29) {
+                        return false;
+                    }
+                    s->match_dist = dist_base[dist_symbol] + png_get_bits_(s, dist_extra[dist_symbol]);
+                    if ((Uint32) s->match_dist > s->total_out) {
+                        return false;
+                    }
+                }
+                break;
+            }
+            case PNG_BLOCK_DONE:
+                return false; // the image wants more data than the stream has
+        }
+    }
+    return true;
+}
+
+static inline int png_paeth_(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = SDL_abs(p - a);
+    const int pb = SDL_abs(p - b);
+    const int pc = SDL_abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+// Inflate the next scanline into `row` (filter byte first) and undo its filter against `prev` (NULL for the top).
+static inline bool png_next_row_(png_stream_t *s, Uint8 *row, Uint8 const *prev) {
+    if (!png_inflate_(s, row, s->row_bytes + 1)) {
+        return false;
+    }
+    const int bpp = s->filter_bpp;
+    Uint8 *cur = row + 1;
+    Uint8 const *up = prev ? prev + 1 : NULL;
+    const int n = s->row_bytes;
+    switch (row[0]) {
+        case 0: break;
+        case 1:
+            for (int i = bpp; i < n; i++) {
+                cur[i] += cur[i - bpp];
+            }
+            break;
+        case 2:
+            if (up) {
+                for (int i = 0; i < n; i++) {
+                    cur[i] += up[i];
+                }
+            }
+            break;
+        case 3:
+            for (int i = 0; i < n; i++) {
+                const int left = i >= bpp ? cur[i - bpp] : 0;
+                cur[i] += (Uint8) ((left + (up ? up[i] : 0)) >> 1);
+            }
+            break;
+        case 4:
+            for (int i = 0; i < n; i++) {
+                const int left = i >= bpp ? cur[i - bpp] : 0;
+                const int above = up ? up[i] : 0;
+                const int corner = (up && i >= bpp) ? up[i - bpp] : 0;
+                cur[i] += (Uint8) png_paeth_(left, above, corner);
+            }
+            break;
+        default: return false;
+    }
+    return true;
+}
+
+static inline int png_sample_(png_stream_t const *s, Uint8 const *data, int index) {
+    switch (s->depth) {
+        case 16: return data[index * 2];
+        case 8: return data[index];
+        default: {
+            const int per_byte = 8 / s->depth;
+            const int shift = (per_byte - 1 - index % per_byte) * s->depth;
+            return (data[index / per_byte] >> shift) & ((1 << s->depth) - 1);
+        }
+    }
+}
+
+// Unfiltered scanline -> RGBA8888.
+static inline void png_expand_row_(png_stream_t const *s, Uint8 const *raw, Uint8 *rgba) {
+    const int scale = s->depth < 8 ? 255 / ((1 << s->depth) - 1) : 1; // gray at low depths
+    for (int x = 0; x < s->width; x++) {
+        Uint8 *out = &rgba[x * 4];
+        const int base = x * s->channels;
+        switch (s->color_type) {
+            case 0: out[0] = out[1] = out[2] = (Uint8) (png_sample_(s, raw, base) * scale); out[3] = 255; break;
+            case 2:
+                out[0] = (Uint8) png_sample_(s, raw, base);
+                out[1] = (Uint8) png_sample_(s, raw, base + 1);
+                out[2] = (Uint8) png_sample_(s, raw, base + 2);
+                out[3] = 255;
+                break;
+            case 3: SDL_memcpy(out, s->palette[png_sample_(s, raw, base)], 4); break;
+            case 4:
+                out[0] = out[1] = out[2] = (Uint8) png_sample_(s, raw, base);
+                out[3] = (Uint8) png_sample_(s, raw, base + 1);
+                break;
+            default:
+                out[0] = (Uint8) png_sample_(s, raw, base);
+                out[1] = (Uint8) png_sample_(s, raw, base + 1);
+                out[2] = (Uint8) png_sample_(s, raw, base + 2);
+                out[3] = (Uint8) png_sample_(s, raw, base + 3);
+                break;
+        }
+    }
+}
+
+// Signature, IHDR and everything up to the first IDAT.
+static inline png_result_t png_read_header_(png_stream_t *s) {
+    Uint8 buf[8 + 8 + 13];
+    if (!png_read_(s, buf, 8 + 8 + 13)) {
+        return PNG_ERR_IO;
+    }
+    if (SDL_memcmp(buf, "\x89PNG\r\n\x1a\n", 8) != 0 || SDL_memcmp(&buf[12], "IHDR", 4) != 0) {
+        return PNG_ERR_FORMAT;
+    }
+    Uint8 const *ihdr = &buf[16];
+    s->width = (int) png_be32_(&ihdr[0]);
+    s->height = (int) png_be32_(&ihdr[4]);
+    s->depth = ihdr[8];
+    s->color_type = ihdr[9];
+    static const int channels[7] = {1, 0, 3, 1, 2, 0, 4};
+    // Bit depths the spec allows per color type as bits (1 << depth): gray 1-16, palette 1-8, the rest 8 or 16
+    static const Uint32 depths[7] = {0x10116, 0, 0x10100, 0x116, 0x10100, 0, 0x10100};
+    if (s->color_type > 6 || channels[s->color_type] == 0 || s->depth > 16 ||
+        !(depths[s->color_type] & (1u << s->depth)) || s->width <= 0 || s->height <= 0 || s->width > 16384 ||
+        ihdr[10] != 0 || ihdr[11] != 0) {
+        return PNG_ERR_FORMAT;
+    }
+    if (ihdr[12] != 0) {
+        return PNG_ERR_UNSUPPORTED; // interlaced
+    }
+    s->channels = channels[s->color_type];
+    s->row_bytes = (s->width * s->channels * s->depth + 7) / 8;
+    s->filter_bpp = SDL_max(1, s->channels * s->depth / 8);
+
+    for (int i = 0; i < 256; i++) {
+        s->palette[i][0] = s->palette[i][1] = s->palette[i][2] = 0;
+        s->palette[i][3] = 255;
+    }
+    SDL_SeekIO(s->io, 4, SDL_IO_SEEK_CUR); // IHDR CRC
+    for (;;) {
+        Uint8 header[8];
+        if (!png_read_(s, header, sizeof(header))) {
+            return PNG_ERR_FORMAT;
+        }
+        const Uint32 len = png_be32_(header);
+        if (SDL_memcmp(&header[4], "IDAT", 4) == 0) {
+            s->chunk_left = len;
+            break;
+        }
+        if (SDL_memcmp(&header[4], "PLTE", 4) == 0 && len <= 768 && len % 3 == 0) {
+            Uint8 rgb[768];
+            if (!png_read_(s, rgb, len)) {
+                return PNG_ERR_IO;
+            }
+            for (Uint32 i = 0; i < len / 3; i++) {
+                SDL_memcpy(s->palette[i], &rgb[i * 3], 3);
+            }
+            SDL_SeekIO(s->io, 4, SDL_IO_SEEK_CUR);
+        } else if (SDL_memcmp(&header[4], "tRNS", 4) == 0 && s->color_type == 3 && len <= 256) {
+            Uint8 alpha[256];
+            if (!png_read_(s, alpha, len)) {
+                return PNG_ERR_IO;
+            }
+            for (Uint32 i = 0; i < len; i++) {
+                s->palette[i][3] = alpha[i];
+            }
+            SDL_SeekIO(s->io, 4, SDL_IO_SEEK_CUR);
+        } else if (SDL_SeekIO(s->io, (Sint64) len + 4, SDL_IO_SEEK_CUR) < 0) {
+            return PNG_ERR_FORMAT;
+        }
+    }
+
+    // zlib header: deflate, no preset dictionary
+    const int cmf = png_next_byte_(s);
+    const int flg = png_next_byte_(s);
+    if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) {
+        return PNG_ERR_FORMAT;
+    }
+    return PNG_OK;
+}
+
+static inline Uint8 *png_row_slot_(png_stream_t *s, int y) {
+    return &s->rows[(y % PNG_PIPE_ROWS) * (s->row_bytes + 1)];
+}
+
+// Worker: inflate and unfilter rows into the ring as fast as the consumer frees slots.
+static int SDLCALL png_inflate_thread_(void *data) {
+    png_stream_t *s = (png_stream_t *) data;
+    for (int y = 0; y < s->height; y++) {
+        SDL_WaitSemaphore(s->free_rows);
+        if (!png_next_row_(s, png_row_slot_(s, y), y > 0 ? png_row_slot_(s, y - 1) : NULL)) {
+            s->status = PNG_ERR_FORMAT;
+            SDL_SignalSemaphore(s->full_rows);
+            return 0;
+        }
+        SDL_SignalSemaphore(s->full_rows);
+    }
+    return 0;
+}
+
+// Decode the PNG in `io` row by row into `row_fn`. Does not close `io`.
+static inline png_result_t png_stream_decode(SDL_IOStream *io, png_row_fn row_fn, void *userdata, bool threaded) {
+    png_stream_t *s = (png_stream_t *) SDL_calloc(1, sizeof(png_stream_t));
+    if (!s) {
+        return PNG_ERR_MEMORY;
+    }
+    s->io = io;
+    png_result_t result = png_read_header_(s);
+    if (result != PNG_OK) {
+        SDL_free(s);
+        return result;
+    }
+    s->rows = (Uint8 *) SDL_malloc((size_t) PNG_PIPE_ROWS * (s->row_bytes + 1));
+    s->rgba = (Uint8 *) SDL_malloc((size_t) s->width * 4);
+    if (!s->rows || !s->rgba) {
+        SDL_free(s->rows);
+        SDL_free(s->rgba);
+        SDL_free(s);
+        return PNG_ERR_MEMORY;
+    }
+
+    SDL_Thread *worker = NULL;
+    if (threaded && SDL_GetNumLogicalCPUCores() > 1) {
+        // One slot stays with the worker as the previous row of the one it's filtering
+        s->free_rows = SDL_CreateSemaphore(PNG_PIPE_ROWS - 1);
+        s->full_rows = SDL_CreateSemaphore(0);
+        if (s->free_rows && s->full_rows) {
+            worker = SDL_CreateThread(png_inflate_thread_, "png_inflate", s);
+        }
+    }
+
+    for (int y = 0; y < s->height; y++) {
+        Uint8 *row = png_row_slot_(s, y);
+        if (worker) {
+            SDL_WaitSemaphore(s->full_rows);
+            if (s->status != PNG_OK) {
+                break;
+            }
+        } else if (!png_next_row_(s, row, y > 0 ? png_row_slot_(s, y - 1) : NULL)) {
+            s->status = PNG_ERR_FORMAT;
+            break;
+        }
+        png_expand_row_(s, row + 1, s->rgba);
+        row_fn(userdata, y, s->rgba, s->width);
+        if (worker) {
+            SDL_SignalSemaphore(s->free_rows);
+        }
+    }
+
+    if (worker) {
+        SDL_WaitThread(worker, NULL);
+    }
+    SDL_DestroySemaphore(s->free_rows);
+    SDL_DestroySemaphore(s->full_rows);
+    result = s->status;
+    SDL_free(s->rows);
+    SDL_free(s->rgba);
+    SDL_free(s);
+    return result;
+}
+
+// Just the dimensions, from the IHDR.
+static inline bool png_stream_info(SDL_IOStream *io, int *width, int *height) {
+    Uint8 buf[24];
+    if (SDL_ReadIO(io, buf, sizeof(buf)) != sizeof(buf) || SDL_memcmp(buf, "\x89PNG\r\n\x1a\n", 8) != 0) {
+        return false;
+    }
+    *width = (int) png_be32_(&buf[16]);
+    *height = (int) png_be32_(&buf[20]);
+    return true;
+}
@@ -0,0 +1,232 @@
+//
+// Tile pyramid: a map far larger than RAM, stored as R5Z tiles (r5z.h) and decoded only where it is looked at.
+//
+// Level 0 is the base image the app already has (base_width x base_height); level k is the same map at 2^k times that
+// size, cut into tile_size squares (right and bottom tiles may be smaller). Decoded tiles live in a fixed set of
+// cache slots; a miss reads one tile from the file and evicts the least recently used slot. tools/r5zenc.c -t writes
+// the file:
+//
+//     Header, 16 bytes:  "R5P1"  u16 tile_size  u8 levels  u8 0  u16 base_width  u16 base_height
+//                        u32 largest tile in bytes
+//     Offsets:           u32 per tile of levels 1..levels in row-major order, then one for the end of the last tile
+//     Tiles:             R5Z images
+//
+//     tiles_t tiles;
+//     if (tiles_open(&tiles, "MAP.R5P", 64)) {
+//         tiles_draw(&tiles, level, view_x, view_y, framebuffer, 720, 720);
+//     }
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include "r5z.h"
+
+#define TILES_HEADER_SIZE  16
+#define TILES_MAX_LEVELS   8
+#define TILES_DEFAULT_SIZE 128
+
+typedef struct {
+    int level; // 0: empty slot
+    int col;
+    int row;
+    Uint64 last_used;
+} tiles_slot_t;
+
+typedef struct {
+    SDL_IOStream *io;
+    int tile_size;
+    int levels;
+    int base_width;
+    int base_height;
+    Uint32 *offsets;
+    int first[TILES_MAX_LEVELS + 1]; // index of each level's first tile in offsets
+    Uint8 *blob;                     // one compressed tile
+    Uint32 blob_size;
+    tiles_slot_t *slots;
+    Uint16 *pixels;                  // slot_count tiles of tile_size x tile_size
+    int slot_count;
+    Uint64 clock;
+    // Statistics
+    Uint32 hits;
+    Uint32 misses;
+    Uint32 evictions;
+} tiles_t;
+
+static inline int tiles_level_width(tiles_t const *t, const int level) {
+    return t->base_width << level;
+}
+
+static inline int tiles_level_height(tiles_t const *t, const int level) {
+    return t->base_height << level;
+}
+
+static inline int tiles_cols_(tiles_t const *t, const int level) {
+    return (tiles_level_width(t, level) + t->tile_size - 1) / t->tile_size;
+}
+
+static inline int tiles_rows_(tiles_t const *t, const int level) {
+    return (tiles_level_height(t, level) + t->tile_size - 1) / t->tile_size;
+}
+
+static inline void tiles_close(tiles_t *t) {
+    if (t->io) {
+        SDL_CloseIO(t->io);
+    }
+    SDL_free(t->offsets);
+    SDL_free(t->blob);
+    SDL_free(t->slots);
+    SDL_free(t->pixels);
+    SDL_zerop(t);
+}
+
+// Open a pyramid with room for `slot_count` decoded tiles. False if the file is missing or not a valid pyramid.
+static inline bool tiles_open(tiles_t *t, char const *path, const int slot_count) {
+    SDL_zerop(t);
+    t->io = SDL_IOFromFile(path, "rb");
+    Uint8 header[TILES_HEADER_SIZE];
+    if (!t->io || SDL_ReadIO(t->io, header, sizeof(header)) != sizeof(header) || SDL_memcmp(header, "R5P1", 4) != 0) {
+        tiles_close(t);
+        return false;
+    }
+    t->tile_size = r5z_u16_(&header[4]);
+    t->levels = header[6];
+    t->base_width = r5z_u16_(&header[8]);
+    t->base_height = r5z_u16_(&header[10]);
+    t->blob_size = r5z_u32_(&header[12]);
+    if (t->tile_size <= 0 || t->tile_size > R5Z_MAX_WIDTH || t->levels <= 0 || t->levels > TILES_MAX_LEVELS ||
+        t->base_width <= 0 || t->base_height <= 0 || t->blob_size < R5Z_HEADER_SIZE) {
+        tiles_close(t);
+        return false;
+    }
+
+    int count = 0;
+    for (int level = 1; level <= t->levels; level++) {
+        t->first[level] = count;
+        count += tiles_cols_(t, level) * tiles_rows_(t, level);
+    }
+    const size_t tile_pixels = (size_t) t->tile_size * t->tile_size;
+    t->offsets = (Uint32 *) SDL_malloc((size_t) (count + 1) * sizeof(Uint32));
+    t->blob = (Uint8 *) SDL_malloc(t->blob_size);
+    t->slots = (tiles_slot_t *) SDL_calloc((size_t) slot_count, sizeof(tiles_slot_t));
+    t->pixels = (Uint16 *) SDL_malloc((size_t) slot_count * tile_pixels * sizeof(Uint16));
+    if (!t->offsets || !t->blob || !t->slots || !t->pixels) {
+        tiles_close(t);
+        return false;
+    }
+    t->slot_count = slot_count;
+    const size_t offsets_size = (size_t) (count + 1) * sizeof(Uint32);
+    if (SDL_ReadIO(t->io, t->offsets, offsets_size) != offsets_size) {
+        tiles_close(t);
+        return false;
+    }
+    for (int i = 0; i <= count; i++) {
+        t->offsets[i] = r5z_u32_((Uint8 const *) &t->offsets[i]); // stored little-endian
+    }
+    return true;
+}
+
+// Decoded pixels of one tile (tile_size wide rows), reading it in if it isn't cached. NULL if it can't be read.
+static inline Uint16 const *tiles_get(tiles_t *t, const int level, const int col, const int row) {
+    if (level < 1 || level > t->levels || col < 0 || row < 0 || col >= tiles_cols_(t, level) ||
+        row >= tiles_rows_(t, level)) {
+        return NULL;
+    }
+    const size_t tile_pixels = (size_t) t->tile_size * t->tile_size;
+    int victim = 0;
+    for (int s = 0; s < t->slot_count; s++) {
+        tiles_slot_t *slot = &t->slots[s];
+        if (slot->level == level && slot->col == col && slot->row == row) {
+            slot->last_used = ++t->clock;
+            t->hits++;
+            return &t->pixels[s * tile_pixels];
+        }
+        if (slot->last_used < t->slots[victim].last_used) {
+            victim = s;
+        }
+    }
+
+    t->misses++;
+    tiles_slot_t *slot = &t->slots[victim];
+    if (slot->level != 0) {
+        t->evictions++;
+    }
+    slot->level = 0;
+    const int index = t->first[level] + row * tiles_cols_(t, level) + col;
+    const Uint32 start = t->offsets[index];
+    const Uint32 size = t->offsets[index + 1] - start;
+    Uint16 *pixels = &t->pixels[victim * tile_pixels];
+    if (size > t->blob_size || SDL_SeekIO(t->io, start, SDL_IO_SEEK_SET) < 0 ||
+        SDL_ReadIO(t->io, t->blob, size) != size ||
+        !r5z_blit(t->blob, size, pixels, t->tile_size, t->tile_size, 0, 0)) {
+        return NULL;
+    }
+    *slot = (tiles_slot_t) {level, col, row, ++t->clock};
+    return pixels;
+}
+
+static inline bool tiles_cached(tiles_t const *t, const int level, const int col, const int row) {
+    for (int s = 0; s < t->slot_count; s++) {
+        if (t->slots[s].level == level && t->slots[s].col == col && t->slots[s].row == row) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Copy the part of `level` whose top-left corner is (view_x, view_y) into `framebuffer`. The view must lie inside
+// the level. Tiles that can't be read are left as they were.
+static inline void tiles_draw(
+    tiles_t *t, const int level, const int view_x, const int view_y, Uint16 *framebuffer, const int fb_width,
+    const int fb_height
+) {
+    const int size = t->tile_size;
+    for (int row = view_y / size; row * size < view_y + fb_height; row++) {
+        for (int col = view_x / size; col * size < view_x + fb_width; col++) {
+            Uint16 const *tile = tiles_get(t, level, col, row);
+            if (!tile) {
+                continue;
+            }
+            const int x0 = SDL_max(col * size, view_x);
+            const int x1 = SDL_min(SDL_min((col + 1) * size, view_x + fb_width), tiles_level_width(t, level));
+            const int y0 = SDL_max(row * size, view_y);
+            const int y1 = SDL_min(SDL_min((row + 1) * size, view_y + fb_height), tiles_level_height(t, level));
+            for (int y = y0; y < y1; y++) {
+                px_copy_u16(
+                    &framebuffer[(y - view_y) * fb_width + (x0 - view_x)],
+                    &tile[(y - row * size) * size + (x0 - col * size)], x1 - x0
+                );
+            }
+        }
+    }
+}
+
+// Read in up to `max` uncached tiles just past the view's edge in the direction it is moving (dx, dy: -1, 0 or 1).
+// Returns how many were read; 0 means that edge is already cached.
+static inline int tiles_prefetch(
+    tiles_t *t, const int level, const int view_x, const int view_y, const int fb_width, const int fb_height,
+    const int dx, const int dy, const int max
+) {
+    const int size = t->tile_size;
+    const int col0 = view_x / size, col1 = (view_x + fb_width - 1) / size;
+    const int row0 = view_y / size, row1 = (view_y + fb_height - 1) / size;
+    int read = 0;
+    if (dx != 0) {
+        const int col = dx > 0 ? col1 + 1 : col0 - 1;
+        for (int row = row0; row <= row1 && read < max; row++) {
+            if (!tiles_cached(t, level, col, row) && tiles_get(t, level, col, row)) {
+                read++;
+            }
+        }
+    }
+    if (dy != 0) {
+        const int row = dy > 0 ? row1 + 1 : row0 - 1;
+        for (int col = col0; col <= col1 && read < max; col++) {
+            if (!tiles_cached(t, level, col, row) && tiles_get(t, level, col, row)) {
+                read++;
+            }
+        }
+    }
+    return read;
+}
@@ -0,0 +1,133 @@
+//
+// Deadline scheduler for event loops that should sleep instead of spin.
+//
+// A binary min-heap of timers on the monotonic millisecond clock (SDL_GetTicks). Timers are small integer ids the
+// caller picks (0 .. capacity-1), so there is nothing to allocate per timer; arming an id that is already armed just
+// moves it. The loop sleeps until timers_next_deadline() (or input), then runs whatever timers_pop_due() hands back.
+//
+//     timers_set(&timers, FETCH_TIMER, SDL_GetTicks() + 30000);
+//     const Uint32 wait = timers_wait_ms(&timers, SDL_GetTicks(), 1000);
+//     ...block for input up to `wait` ms...
+//     for (int id; (id = timers_pop_due(&timers, SDL_GetTicks())) >= 0;) { ... }
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#define TIMERS_NEVER SDL_MAX_UINT64
+
+typedef struct {
+    Uint64 *deadline; // per id
+    int *position;    // per id: index in heap, -1 when not armed
+    int *heap;        // armed ids, earliest deadline first
+    int count;
+    int capacity;
+} timers_t;
+
+static inline bool timers_init(timers_t *t, const int capacity) {
+    SDL_zerop(t);
+    t->deadline = (Uint64 *) SDL_calloc((size_t) capacity, sizeof(Uint64));
+    t->position = (int *) SDL_malloc((size_t) capacity * sizeof(int));
+    t->heap = (int *) SDL_malloc((size_t) capacity * sizeof(int));
+    if (!t->deadline || !t->position || !t->heap) {
+        SDL_free(t->deadline);
+        SDL_free(t->position);
+        SDL_free(t->heap);
+        SDL_zerop(t);
+        return false;
+    }
+    for (int i = 0; i < capacity; i++) {
+        t->position[i] = -1;
+    }
+    t->capacity = capacity;
+    return true;
+}
+
+static inline void timers_destroy(timers_t *t) {
+    SDL_free(t->deadline);
+    SDL_free(t->position);
+    SDL_free(t->heap);
+    SDL_zerop(t);
+}
+
+static inline bool timers_before_(timers_t const *t, const int a, const int b) {
+    return t->deadline[t->heap[a]] < t->deadline[t->heap[b]];
+}
+
+static inline void timers_swap_(timers_t *t, const int a, const int b) {
+    const int id = t->heap[a];
+    t->heap[a] = t->heap[b];
+    t->heap[b] = id;
+    t->position[t->heap[a]] = a;
+    t->position[t->heap[b]] = b;
+}
+
+static inline void timers_sift_(timers_t *t, int i) {
+    while (i > 0 && timers_before_(t, i, (i - 1) / 2)) {
+        timers_swap_(t, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    for (;;) {
+        const int left = 2 * i + 1;
+        int first = i;
+        if (left < t->count && timers_before_(t, left, first)) {
+            first = left;
+        }
+        if (left + 1 < t->count && timers_before_(t, left + 1, first)) {
+            first = left + 1;
+        }
+        if (first == i) {
+            return;
+        }
+        timers_swap_(t, i, first);
+        i = first;
+    }
+}
+
+// Arm (or move) timer `id` to fire at `deadline` (SDL_GetTicks() time).
+static inline void timers_set(timers_t *t, const int id, const Uint64 deadline) {
+    SDL_assert(id >= 0 && id < t->capacity);
+    t->deadline[id] = deadline;
+    if (t->position[id] < 0) {
+        t->position[id] = t->count;
+        t->heap[t->count++] = id;
+    }
+    timers_sift_(t, t->position[id]);
+}
+
+static inline void timers_cancel(timers_t *t, const int id) {
+    const int i = t->position[id];
+    if (i < 0) {
+        return;
+    }
+    timers_swap_(t, i, --t->count);
+    t->position[id] = -1;
+    if (i < t->count) {
+        timers_sift_(t, i);
+    }
+}
+
+static inline bool timers_armed(timers_t const *t, const int id) {
+    return t->position[id] >= 0;
+}
+
+static inline Uint64 timers_next_deadline(timers_t const *t) {
+    return t->count > 0 ? t->deadline[t->heap[0]] : TIMERS_NEVER;
+}
+
+// How long to sleep from `now` until the next deadline, capped at `max_ms`. 0 means something is due.
+static inline Uint32 timers_wait_ms(timers_t const *t, const Uint64 now, const Uint32 max_ms) {
+    const Uint64 next = timers_next_deadline(t);
+    return next <= now ? 0 : (Uint32) SDL_min(next - now, (Uint64) max_ms);
+}
+
+// Disarm and return the earliest timer that is due at `now`, or -1 if none is.
+static inline int timers_pop_due(timers_t *t, const Uint64 now) {
+    if (t->count == 0 || t->deadline[t->heap[0]] > now) {
+        return -1;
+    }
+    const int id = t->heap[0];
+    timers_cancel(t, id);
+    return id;
+}
@@ -0,0 +1,318 @@
+//
+// r5zenc: converts PNGs into R5Z (see r5z.h), either as a .r5z file or as a C header for embedding, or into an R5Z
+// tile pyramid (see tiles.h).
+//
+//     r5zenc background.png background.r5z
+//     r5zenc -c background_r5z background.png spacestate_nl/background_r5z.h
+//     r5zenc -t 3 720 map_large.png map.r5p
+//
+// Colors are truncated to RGB565 the same way px_rgb565() does. Images with any alpha below 255 get an alpha plane.
+// A pyramid gets `levels` levels above a base_width wide level 0 (which is not stored), each resampled from the
+// input: averaged where the input is larger, bilinear where it is smaller.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "r5z.h"
+#include "tiles.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include "spacestate_nl/stb_image.h"
+
+typedef struct {
+    Uint8 *data;
+    size_t size;
+    size_t capacity;
+} buffer_t;
+
+static void put(buffer_t *b, const Uint8 byte) {
+    if (b->size == b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : 4096;
+        b->data = realloc(b->data, b->capacity);
+        if (!b->data) {
+            fprintf(stderr, "r5zenc: out of memory\n");
+            exit(1);
+        }
+    }
+    b->data[b->size++] = byte;
+}
+
+static void put_u16(buffer_t *b, const Uint16 value) {
+    put(b, (Uint8) value);
+    put(b, (Uint8) (value >> 8));
+}
+
+static void put_u32_at(buffer_t *b, const size_t at, const Uint32 value) {
+    for (int i = 0; i < 4; i++) {
+        b->data[at + i] = (Uint8) (value >> (8 * i));
+    }
+}
+
+static void flush_run(buffer_t *b, Uint32 *run) {
+    while (*run > 0) {
+        if (*run >= 63) {
+            const Uint32 count = SDL_min(*run, (Uint32) R5Z_LONG_RUN_MAX);
+            put(b, R5Z_OP_LONG);
+            put_u16(b, (Uint16) (count - 63));
+            *run -= count;
+        } else {
+            put(b, (Uint8) (R5Z_OP_RUN | (*run - 1)));
+            *run = 0;
+        }
+    }
+}
+
+// Wrapped difference of two channel values with `bits` bits, as -2^(bits-1) .. 2^(bits-1)-1
+static int wrap_diff(const int a, const int b, const int bits) {
+    const int range = 1 << bits;
+    int d = (a - b) & (range - 1);
+    return d >= range / 2 ? d - range : d;
+}
+
+static void encode_pixels(buffer_t *b, Uint16 const *pixels, const size_t count) {
+    Uint16 index[64] = {0};
+    Uint16 prev = 0;
+    Uint32 run = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Uint16 c = pixels[i];
+        if (c == prev) {
+            run++;
+            continue;
+        }
+        flush_run(b, &run);
+
+        const int hash = r5z_hash(c);
+        if (index[hash] == c) {
+            put(b, (Uint8) (R5Z_OP_INDEX | hash));
+        } else {
+            const int dr = wrap_diff(c >> 11, prev >> 11, 5);
+            const int dg = wrap_diff((c >> 5) & 0x3F, (prev >> 5) & 0x3F, 6);
+            const int db = wrap_diff(c & 0x1F, prev & 0x1F, 5);
+            const int dr_dg = wrap_diff(dr - dg / 2, 0, 5);
+            const int db_dg = wrap_diff(db - dg / 2, 0, 5);
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                put(b, (Uint8) (R5Z_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+            } else if (dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+                put(b, (Uint8) (R5Z_OP_LUMA | (dg + 32)));
+                put(b, (Uint8) (((dr_dg + 8) << 4) | (db_dg + 8)));
+            } else {
+                put(b, R5Z_OP_RGB);
+                put_u16(b, c);
+            }
+            index[hash] = c;
+        }
+        prev = c;
+    }
+    flush_run(b, &run);
+}
+
+static void encode_alpha(buffer_t *b, Uint8 const *alpha, const size_t count) {
+    for (size_t i = 0; i < count;) {
+        size_t n = 1;
+        while (i + n < count && n < 256 && alpha[i + n] == alpha[i]) {
+            n++;
+        }
+        put(b, (Uint8) (n - 1));
+        put(b, alpha[i]);
+        i += n;
+    }
+}
+
+static int write_output(buffer_t const *b, char const *path, char const *c_name);
+
+// Append `rgba` (w x h) to `b` as a complete R5Z image
+static void encode_image(buffer_t *b, Uint8 const *rgba, const int w, const int h) {
+    const size_t count = (size_t) w * h;
+    const size_t start = b->size;
+    Uint16 *pixels = malloc(count * sizeof(Uint16));
+    Uint8 *alpha = malloc(count);
+    if (!pixels || !alpha) {
+        fprintf(stderr, "r5zenc: out of memory\n");
+        exit(1);
+    }
+    bool has_alpha = false;
+    for (size_t i = 0; i < count; i++) {
+        Uint8 const *px = &rgba[i * 4];
+        alpha[i] = px[3];
+        has_alpha |= px[3] != 255;
+        // Hidden pixels take their left neighbour's color so they fold into runs
+        pixels[i] = (px[3] == 0 && i > 0) ? pixels[i - 1] : px_rgb565_from_rgb(px[0], px[1], px[2]);
+    }
+
+    for (int i = 0; i < R5Z_HEADER_SIZE; i++) {
+        put(b, 0);
+    }
+    Uint8 *header = &b->data[start];
+    memcpy(header, "R5Z1", 4);
+    header[4] = (Uint8) w;
+    header[5] = (Uint8) (w >> 8);
+    header[6] = (Uint8) h;
+    header[7] = (Uint8) (h >> 8);
+    encode_pixels(b, pixels, count);
+    if (has_alpha) {
+        put_u32_at(b, start + 8, (Uint32) (b->size - start));
+        encode_alpha(b, alpha, count);
+    }
+    put_u32_at(b, start + 12, (Uint32) (b->size - start));
+    free(pixels);
+    free(alpha);
+}
+
+// Sample `src` (sw x sh RGBA) for pixel (x, y) of the same picture scaled to dw x dh
+static void resample(Uint8 const *src, const int sw, const int sh, const int dw, const int dh, const int x,
+                     const int y, Uint8 *out) {
+    const double scale_x = (double) sw / dw, scale_y = (double) sh / dh;
+    if (scale_x >= 1.0 && scale_y >= 1.0) {
+        // Average the footprint
+        const int x0 = (int) (x * scale_x), x1 = SDL_max(x0 + 1, (int) ((x + 1) * scale_x));
+        const int y0 = (int) (y * scale_y), y1 = SDL_max(y0 + 1, (int) ((y + 1) * scale_y));
+        int sum[4] = {0};
+        for (int sy = y0; sy < y1 && sy < sh; sy++) {
+            for (int sx = x0; sx < x1 && sx < sw; sx++) {
+                for (int c = 0; c < 4; c++) {
+                    sum[c] += src[((size_t) sy * sw + sx) * 4 + c];
+                }
+            }
+        }
+        const int n = (SDL_min(y1, sh) - y0) * (SDL_min(x1, sw) - x0);
+        for (int c = 0; c < 4; c++) {
+            out[c] = (Uint8) ((sum[c] + n / 2) / n);
+        }
+        return;
+    }
+    const double fx = SDL_clamp((x + 0.5) * scale_x - 0.5, 0.0, sw - 1.0);
+    const double fy = SDL_clamp((y + 0.5) * scale_y - 0.5, 0.0, sh - 1.0);
+    const int x0 = (int) fx, y0 = (int) fy;
+    const int x1 = SDL_min(x0 + 1, sw - 1), y1 = SDL_min(y0 + 1, sh - 1);
+    const double ax = fx - x0, ay = fy - y0;
+    for (int c = 0; c < 4; c++) {
+        const double top = src[((size_t) y0 * sw + x0) * 4 + c] * (1 - ax) + src[((size_t) y0 * sw + x1) * 4 + c] * ax;
+        const double bottom =
+            src[((size_t) y1 * sw + x0) * 4 + c] * (1 - ax) + src[((size_t) y1 * sw + x1) * 4 + c] * ax;
+        out[c] = (Uint8) (top * (1 - ay) + bottom * ay + 0.5);
+    }
+}
+
+static int write_pyramid(Uint8 const *rgba, const int w, const int h, const int levels, const int base_width,
+                         char const *path) {
+    const int tile_size = TILES_DEFAULT_SIZE;
+    const int base_height = (int) ((double) h * base_width / w + 0.5);
+    if (levels < 1 || levels > TILES_MAX_LEVELS || base_width <= 0 || base_width > 0xFFFF || base_height > 0xFFFF) {
+        fprintf(stderr, "r5zenc: bad pyramid size\n");
+        return 2;
+    }
+    int count = 0;
+    for (int level = 1; level <= levels; level++) {
+        count += (((base_width << level) + tile_size - 1) / tile_size) *
+                 (((base_height << level) + tile_size - 1) / tile_size);
+    }
+
+    buffer_t b = {0};
+    for (int i = 0; i < TILES_HEADER_SIZE + (count + 1) * 4; i++) {
+        put(&b, 0);
+    }
+    memcpy(b.data, "R5P1", 4);
+    b.data[4] = (Uint8) tile_size;
+    b.data[5] = (Uint8) (tile_size >> 8);
+    b.data[6] = (Uint8) levels;
+    b.data[8] = (Uint8) base_width;
+    b.data[9] = (Uint8) (base_width >> 8);
+    b.data[10] = (Uint8) base_height;
+    b.data[11] = (Uint8) (base_height >> 8);
+
+    Uint8 *tile = malloc((size_t) tile_size * tile_size * 4);
+    Uint32 largest = 0;
+    int index = 0;
+    for (int level = 1; level <= levels; level++) {
+        const int lw = base_width << level, lh = base_height << level;
+        for (int ty = 0; ty < lh; ty += tile_size) {
+            for (int tx = 0; tx < lw; tx += tile_size) {
+                const int tw = SDL_min(tile_size, lw - tx), th = SDL_min(tile_size, lh - ty);
+                for (int y = 0; y < th; y++) {
+                    for (int x = 0; x < tw; x++) {
+                        resample(rgba, w, h, lw, lh, tx + x, ty + y, &tile[((size_t) y * tw + x) * 4]);
+                    }
+                }
+                const size_t start = b.size;
+                put_u32_at(&b, TILES_HEADER_SIZE + (size_t) index++ * 4, (Uint32) start);
+                encode_image(&b, tile, tw, th);
+                largest = SDL_max(largest, (Uint32) (b.size - start));
+            }
+        }
+        printf("level %d: %dx%d\n", level, lw, lh);
+    }
+    put_u32_at(&b, TILES_HEADER_SIZE + (size_t) index * 4, (Uint32) b.size);
+    put_u32_at(&b, 12, largest);
+    printf("%d tiles, %zu bytes, largest tile %u bytes\n", count, b.size, largest);
+    free(tile);
+    const int result = write_output(&b, path, NULL);
+    free(b.data);
+    return result;
+}
+
+static int write_output(buffer_t const *b, char const *path, char const *c_name) {
+    FILE *f = fopen(path, c_name ? "w" : "wb");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    if (c_name) {
+        fprintf(f, "// Generated by tools/r5zenc, do not edit\n");
+        fprintf(f, "unsigned char const %s[] = {", c_name);
+        for (size_t i = 0; i < b->size; i++) {
+            fprintf(f, "%s0x%02x,", i % 12 ? " " : "\n  ", b->data[i]);
+        }
+        fprintf(f, "\n};\nunsigned int const %s_len = %zu;\n", c_name, b->size);
+    } else {
+        fwrite(b->data, 1, b->size, f);
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    char const *c_name = NULL;
+    int levels = 0, base_width = 0;
+    if (argc == 5 && strcmp(argv[1], "-c") == 0) {
+        c_name = argv[2];
+        argv += 2;
+        argc -= 2;
+    } else if (argc == 6 && strcmp(argv[1], "-t") == 0) {
+        levels = atoi(argv[2]);
+        base_width = atoi(argv[3]);
+        argv += 3;
+        argc -= 3;
+    }
+    if (argc != 3) {
+        fprintf(stderr, "usage: r5zenc [-c array_name | -t levels base_width] input.png output\n");
+        return 2;
+    }
+
+    int w, h, comp;
+    Uint8 *rgba = stbi_load(argv[1], &w, &h, &comp, 4);
+    if (!rgba) {
+        fprintf(stderr, "r5zenc: %s: %s\n", argv[1], stbi_failure_reason());
+        return 1;
+    }
+    if (levels) {
+        const int result = write_pyramid(rgba, w, h, levels, base_width, argv[2]);
+        stbi_image_free(rgba);
+        return result;
+    }
+    if (w > R5Z_MAX_WIDTH || h > 0xFFFF) {
+        fprintf(stderr, "r5zenc: %s: %dx%d is larger than R5Z allows\n", argv[1], w, h);
+        return 1;
+    }
+
+    buffer_t b = {0};
+    encode_image(&b, rgba, w, h);
+    printf("%s: %dx%d%s, %zu bytes RGB565 -> %zu bytes\n", argv[1], w, h, r5z_u32_(&b.data[8]) ? " with alpha" : "",
+           (size_t) w * h * sizeof(Uint16), b.size);
+    const int result = write_output(&b, argv[2], c_name);
+    free(b.data);
+    stbi_image_free(rgba);
+    return result;
+}
@@ -0,0 +1,393 @@
+//
+// spaceapi_stub: a stand-in for the SpaceAPI servers Space State NL polls, serving recorded documents with faults
+// injected on request, so the fetcher can be developed and benchmarked without the real servers, reproducibly.
+//
+//     curl -o recorded/bitlair https://bitlair.nl/statejson.php    record a few documents
+//     spaceapi_stub -a 192.168.1.10 -l 40 recorded > SPACES.TXT    serve them on the LAN the badge is on
+//
+// GET /<name> answers with the file recorded/<name>, with an ETag and Last-Modified, and 304 when the client sends
+// the ETag back. On start it prints a SPACES.TXT (see the registry in main_space_state.c) listing every recorded
+// document; copy it to APPS:[SPACESTATE_NL] to point the app at the stub. The address defaults to 127.0.0.1. A query
+// string on a URL picks faults for that space:
+//
+//     delay=ms              extra latency before the answer (on top of -l)
+//     rate=bytes            bandwidth limit in bytes per second (instead of -b)
+//     status=code           answer with that HTTP status and no body
+//     fault=timeout         read the request, then never answer
+//     fault=reset           read the request, then reset the connection
+//     fault=truncate        send half the body, then close (the length says more is coming)
+//     fault=malformed       the document cut off before its "open" key, followed by garbage
+//     fault=huge            the document padded to size=bytes (default 4 MB) of valid JSON; Space State gives
+//                           up past SPACE_BODY_MAX
+//
+// With -x probability every request also gets one of timeout, reset, truncate or malformed at random (seeded with
+// -s, so a run can be repeated). Every request is logged to stderr with what was done and how long it took.
+//
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REQUEST_MAX       8192
+#define SLICES_PER_SECOND 20
+#define HUGE_DEFAULT_SIZE (4 * 1024 * 1024)
+#define TIMEOUT_HOLD_S    120 // longer than any client timeout
+
+typedef enum {
+    FAULT_NONE,
+    FAULT_TIMEOUT,
+    FAULT_RESET,
+    FAULT_TRUNCATE,
+    FAULT_MALFORMED,
+    FAULT_HUGE,
+} fault_e;
+
+static char const *const g_fault_names[] = {"none", "timeout", "reset", "truncate", "malformed", "huge"};
+
+static struct {
+    char const *dir;
+    char const *address;
+    int port;
+    long latency_ms;
+    long rate;         // bytes per second, 0: unlimited
+    double fault_rate; // chance of a random fault per request
+} g_options = {NULL, "127.0.0.1", 8080, 0, 0, 0.0};
+
+typedef struct {
+    char name[256];
+    char if_none_match[128];
+    long delay_ms;
+    long rate;
+    int status;
+    fault_e fault;
+    long size;
+} request_t;
+
+static long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void sleep_ms(const long ms) {
+    if (ms > 0) {
+        struct timespec ts = {ms / 1000, (ms % 1000) * 1000000};
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+        }
+    }
+}
+
+static bool send_all(const int fd, char const *data, size_t size) {
+    while (size > 0) {
+        const ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= (size_t) sent;
+    }
+    return true;
+}
+
+// Send `size` bytes at no more than `rate` bytes per second, in SLICES_PER_SECOND slices
+static bool send_limited(const int fd, char const *data, size_t size, const long rate) {
+    if (rate <= 0) {
+        return send_all(fd, data, size);
+    }
+    const size_t slice = (size_t) (rate / SLICES_PER_SECOND > 0 ? rate / SLICES_PER_SECOND : 1);
+    while (size > 0) {
+        const size_t n = size < slice ? size : slice;
+        if (!send_all(fd, data, n)) {
+            return false;
+        }
+        data += n;
+        size -= n;
+        if (size > 0) {
+            sleep_ms(1000 / SLICES_PER_SECOND);
+        }
+    }
+    return true;
+}
+
+static char *read_file(char const *path, size_t *size, time_t *mtime) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    struct stat st;
+    char *data = NULL;
+    if (fstat(fileno(f), &st) == 0 && (data = malloc((size_t) st.st_size + 1))) {
+        *size = fread(data, 1, (size_t) st.st_size, f);
+        data[*size] = '\0';
+        *mtime = st.st_mtime;
+    }
+    fclose(f);
+    return data;
+}
+
+static uint32_t fnv1a(char const *data, const size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ (uint8_t) data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static long query_long(char const *query, char const *key, const long fallback) {
+    const size_t len = strlen(key);
+    for (char const *p = query; p && *p; p = strchr(p, '&') ? strchr(p, '&') + 1 : NULL) {
+        if (strncmp(p, key, len) == 0 && p[len] == '=') {
+            return strtol(&p[len + 1], NULL, 10);
+        }
+    }
+    return fallback;
+}
+
+// Parse "GET /name?query HTTP/1.1" and the headers we care about. False if it isn't a request for a document.
+static bool parse_request(char *text, request_t *r) {
+    memset(r, 0, sizeof(*r));
+    r->rate = g_options.rate;
+    r->size = HUGE_DEFAULT_SIZE;
+    if (strncmp(text, "GET /", 5) != 0) {
+        return false;
+    }
+    char *path = &text[5];
+    char *end = strchr(path, ' ');
+    if (!end) {
+        return false;
+    }
+    *end = '\0';
+    char *query = strchr(path, '?');
+    if (query) {
+        *query++ = '\0';
+        r->delay_ms = query_long(query, "delay", 0);
+        r->rate = query_long(query, "rate", r->rate);
+        r->status = (int) query_long(query, "status", 0);
+        r->size = query_long(query, "size", r->size);
+        char const *fault = strstr(query, "fault=");
+        for (int f = FAULT_TIMEOUT; fault && f <= FAULT_HUGE; f++) {
+            const size_t len = strlen(g_fault_names[f]);
+            if (strncmp(&fault[6], g_fault_names[f], len) == 0 && (fault[6 + len] == '\0' || fault[6 + len] == '&')) {
+                r->fault = (fault_e) f;
+            }
+        }
+    }
+    if (!*path || strlen(path) >= sizeof(r->name) || strstr(path, "..") || strchr(path, '/')) {
+        return false;
+    }
+    strcpy(r->name, path);
+
+    for (char *line = strstr(&end[1], "\r\n"); line; line = strstr(line, "\r\n")) {
+        line += 2;
+        if (strncasecmp(line, "If-None-Match:", 14) == 0) {
+            char const *value = &line[14];
+            while (*value == ' ') {
+                value++;
+            }
+            const size_t len = strcspn(value, "\r\n");
+            if (len < sizeof(r->if_none_match)) {
+                memcpy(r->if_none_match, value, len);
+                r->if_none_match[len] = '\0';
+            }
+        }
+    }
+    return true;
+}
+
+static bool send_head(const int fd, const int status, char const *reason, const size_t length, char const *extra) {
+    char head[512];
+    const int n = snprintf(
+        head, sizeof(head),
+        "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n%sConnection: close\r\n\r\n",
+        status, reason, length, extra
+    );
+    return send_all(fd, head, (size_t) n);
+}
+
+// Answer one connection and log what was done
+static void serve(const int fd, struct sockaddr_in const *peer) {
+    const long started = now_ms();
+    char text[REQUEST_MAX];
+    size_t size = 0;
+    while (size < sizeof(text) - 1) {
+        const ssize_t got = recv(fd, &text[size], sizeof(text) - 1 - size, 0);
+        if (got <= 0) {
+            break;
+        }
+        size += (size_t) got;
+        text[size] = '\0';
+        if (strstr(text, "\r\n\r\n")) {
+            break;
+        }
+    }
+    text[size] = '\0';
+
+    request_t r;
+    if (!parse_request(text, &r)) {
+        send_head(fd, 400, "Bad Request", 0, "");
+        fprintf(stderr, "%s: bad request\n", inet_ntoa(peer->sin_addr));
+        return;
+    }
+    if (r.fault == FAULT_NONE && g_options.fault_rate > 0 && rand() < g_options.fault_rate * RAND_MAX) {
+        r.fault = (fault_e) (FAULT_TIMEOUT + rand() % (FAULT_MALFORMED - FAULT_TIMEOUT + 1));
+    }
+    sleep_ms(g_options.latency_ms + r.delay_ms);
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", g_options.dir, r.name);
+    size_t body_size = 0;
+    time_t mtime = 0;
+    char *body = read_file(path, &body_size, &mtime);
+    int status = 200;
+    size_t sent = 0;
+    char extra[256] = "";
+    if (r.fault == FAULT_TIMEOUT) {
+        // Hold the connection open without a word until the client gives up
+        const long until = now_ms() + TIMEOUT_HOLD_S * 1000L;
+        while (now_ms() < until && recv(fd, text, sizeof(text), 0) > 0) {
+        }
+        status = 0;
+    } else if (r.fault == FAULT_RESET) {
+        const struct linger linger = {1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+        status = 0;
+    } else if (r.status != 0) {
+        status = r.status;
+        send_head(fd, status, "Injected", 0, "");
+    } else if (!body) {
+        status = 404;
+        send_head(fd, status, "Not Found", 0, "");
+    } else {
+        char date[64];
+        strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", gmtime(&mtime));
+        char etag[16];
+        snprintf(etag, sizeof(etag), "\"%08x\"", fnv1a(body, body_size));
+        snprintf(extra, sizeof(extra), "ETag: %s\r\nLast-Modified: %s\r\n", etag, date);
+        if (r.fault == FAULT_NONE && strcmp(r.if_none_match, etag) == 0) {
+            status = 304;
+            send_head(fd, status, "Not Modified", 0, extra);
+        } else if (r.fault == FAULT_HUGE) {
+            // The document with the padding as whitespace before its closing brace: still valid JSON
+            char const *close = strrchr(body, '}');
+            const size_t head = close ? (size_t) (close - body) : body_size;
+            const size_t pad = (size_t) r.size > body_size ? (size_t) r.size - body_size : 0;
+            bool ok = send_head(fd, status, "OK", head + pad + (body_size - head), "") &&
+                      send_limited(fd, body, head, r.rate);
+            char spaces[4096];
+            memset(spaces, ' ', sizeof(spaces));
+            for (size_t done = 0; ok && done < pad; done += sizeof(spaces)) {
+                const size_t n = pad - done < sizeof(spaces) ? pad - done : sizeof(spaces);
+                ok = send_limited(fd, spaces, n, r.rate);
+            }
+            ok = ok && send_limited(fd, &body[head], body_size - head, r.rate);
+            sent = ok ? head + pad + (body_size - head) : 0;
+        } else if (r.fault == FAULT_MALFORMED) {
+            char const *open = strstr(body, "\"open\"");
+            const size_t keep = open ? (size_t) (open - body) : body_size / 2;
+            static char const garbage[] = "<html>\x01\xff\xfe";
+            send_head(fd, status, "OK", keep + sizeof(garbage) - 1, "");
+            send_limited(fd, body, keep, r.rate);
+            send_all(fd, garbage, sizeof(garbage) - 1);
+            sent = keep + sizeof(garbage) - 1;
+        } else {
+            const size_t length = r.fault == FAULT_TRUNCATE ? body_size / 2 : body_size;
+            if (send_head(fd, status, "OK", body_size, extra) && send_limited(fd, body, length, r.rate)) {
+                sent = length;
+            }
+        }
+    }
+    free(body);
+    fprintf(
+        stderr, "%-24s %3d %-9s %8zu bytes %6ld ms\n", r.name, status, g_fault_names[r.fault], sent,
+        now_ms() - started
+    );
+}
+
+// SPACES.TXT lines for every document in the directory
+static void print_spaces(void) {
+    DIR *dir = opendir(g_options.dir);
+    if (!dir) {
+        return;
+    }
+    printf("# SPACES.TXT for spaceapi_stub on %s:%d\n", g_options.address, g_options.port);
+    for (struct dirent *entry; (entry = readdir(dir));) {
+        if (entry->d_name[0] != '.') {
+            printf("%s\thttp://%s:%d/%s\n", entry->d_name, g_options.address, g_options.port, entry->d_name);
+        }
+    }
+    closedir(dir);
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "a:p:l:b:x:s:")) != -1) {
+        switch (opt) {
+            case 'a': g_options.address = optarg; break;
+            case 'p': g_options.port = atoi(optarg); break;
+            case 'l': g_options.latency_ms = atol(optarg); break;
+            case 'b': g_options.rate = atol(optarg); break;
+            case 'x': g_options.fault_rate = atof(optarg); break;
+            case 's': seed = (unsigned) strtoul(optarg, NULL, 10); break;
+            default: optind = argc + 1; break;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(
+            stderr, "usage: spaceapi_stub [-a address] [-p port] [-l latency_ms] [-b bytes_per_s] [-x fault_rate] "
+                    "[-s seed] dir\n"
+        );
+        return 1;
+    }
+    g_options.dir = argv[optind];
+    srand(seed);
+
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    const int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    struct sockaddr_in address = {0};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t) g_options.port);
+    if (inet_pton(AF_INET, g_options.address, &address.sin_addr) != 1) {
+        fprintf(stderr, "spaceapi_stub: %s is not an IPv4 address\n", g_options.address);
+        return 1;
+    }
+    if (listener < 0 || bind(listener, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(listener, 64)) {
+        fprintf(stderr, "spaceapi_stub: %s:%d: %s\n", g_options.address, g_options.port, strerror(errno));
+        return 1;
+    }
+    print_spaces();
+
+    // One process per connection, so a slow or stalled answer doesn't hold up the others
+    signal(SIGCHLD, SIG_IGN);
+    for (;;) {
+        struct sockaddr_in peer;
+        socklen_t peer_size = sizeof(peer);
+        const int fd = accept(listener, (struct sockaddr *) &peer, &peer_size);
+        if (fd < 0) {
+            continue;
+        }
+        const unsigned request_seed = (unsigned) rand();
+        if (fork() == 0) {
+            close(listener);
+            srand(request_seed);
+            serve(fd, &peer);
+            close(fd);
+            _exit(0);
+        }
+        close(fd);
+    }
+}
@@ -0,0 +1,158 @@
+//
+// Span tracer that writes Chrome / Perfetto "Trace Event Format" JSON.
+//
+// Every thread records begin/end events into its own ring buffer, so recording takes no locks. The main thread's ring
+// holds TRACE_RING_SIZE events, worker threads' (which record far less) TRACE_WORKER_RING_SIZE; both are CMake cache
+// variables.
+// Build with ENABLE_TRACE (cmake -DENABLE_TRACE=ON) to turn it on; otherwise every macro compiles to nothing.
+// Open the dump in chrome://tracing or https://ui.perfetto.dev
+//
+//     TRACE_BEGIN("present");
+//     ...
+//     TRACE_END("present");
+//     trace_dump(TRACE_OUTPUT_PATH);
+//
+// Names must be string literals (or otherwise outlive the dump): only the pointer is recorded.
+// With ENABLE_WATCHDOG the same spans also tell the frame watchdog (watchdog.h) what the UI thread is doing.
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#ifndef TRACE_OUTPUT_PATH
+#ifdef WHY_BADGE
+#define TRACE_OUTPUT_PATH "SD0:trace.json"
+#else
+#define TRACE_OUTPUT_PATH "trace.json"
+#endif
+#endif
+
+#ifdef ENABLE_WATCHDOG
+#include "watchdog.h"
+#define TRACE_WATCHDOG_ENTER_(name) watchdog_enter_(name)
+#define TRACE_WATCHDOG_LEAVE_(name) watchdog_leave_(name)
+#else
+#define TRACE_WATCHDOG_ENTER_(name) ((void) 0)
+#define TRACE_WATCHDOG_LEAVE_(name) ((void) 0)
+#endif
+
+#ifdef ENABLE_TRACE
+
+// Events per ring, oldest are overwritten
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE 8192
+#endif
+#ifndef TRACE_WORKER_RING_SIZE
+#define TRACE_WORKER_RING_SIZE 1024
+#endif
+
+typedef struct {
+    Uint64 ts_ns;
+    char const *name;
+    char phase; // 'B', 'E' or 'i'
+} trace_event_t;
+
+typedef struct trace_ring {
+    Uint32 size;
+    Uint32 head;
+    Uint32 count;
+    SDL_ThreadID tid;
+    struct trace_ring *next;
+    trace_event_t events[];
+} trace_ring_t;
+
+static SDL_TLSID trace_tls_;
+static SDL_SpinLock trace_lock_;
+static trace_ring_t *trace_rings_;
+
+// Rings are never freed: a thread may exit before the dump and its events are still wanted.
+static inline trace_ring_t *trace_ring_(void) {
+    trace_ring_t *ring = (trace_ring_t *) SDL_GetTLS(&trace_tls_);
+    if (!ring) {
+        const Uint32 size = SDL_IsMainThread() ? TRACE_RING_SIZE : TRACE_WORKER_RING_SIZE;
+        ring = (trace_ring_t *) SDL_calloc(1, sizeof(trace_ring_t) + size * sizeof(trace_event_t));
+        if (!ring) {
+            return NULL;
+        }
+        ring->size = size;
+        ring->tid = SDL_GetCurrentThreadID();
+        SDL_SetTLS(&trace_tls_, ring, NULL);
+        SDL_LockSpinlock(&trace_lock_);
+        ring->next = trace_rings_;
+        trace_rings_ = ring;
+        SDL_UnlockSpinlock(&trace_lock_);
+    }
+    return ring;
+}
+
+static inline void trace_record_(char const *name, char phase) {
+    trace_ring_t *ring = trace_ring_();
+    if (!ring) {
+        return;
+    }
+    trace_event_t *e = &ring->events[ring->head];
+    e->ts_ns = SDL_GetTicksNS();
+    e->name = name;
+    e->phase = phase;
+    ring->head = (ring->head + 1) % ring->size;
+    if (ring->count < ring->size) {
+        ring->count++;
+    }
+}
+
+// Other threads keep recording while this runs; their most recent events may be torn or missing.
+static inline bool trace_dump(char const *path) {
+    SDL_IOStream *io = SDL_IOFromFile(path, "w");
+    if (!io) {
+        SDL_Log("trace: could not open %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    SDL_IOprintf(io, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    int total = 0;
+    SDL_LockSpinlock(&trace_lock_);
+    for (trace_ring_t const *ring = trace_rings_; ring; ring = ring->next) {
+        const Uint32 start = (ring->head + ring->size - ring->count) % ring->size;
+        for (Uint32 i = 0; i < ring->count; i++) {
+            trace_event_t const *e = &ring->events[(start + i) % ring->size];
+            SDL_IOprintf(
+                io,
+                "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%" SDL_PRIu64 ".%03u,\"pid\":1,\"tid\":%" SDL_PRIu64 "%s}",
+                first ? "" : ",\n",
+                e->name,
+                e->phase,
+                e->ts_ns / 1000,
+                (unsigned) (e->ts_ns % 1000),
+                (Uint64) ring->tid,
+                e->phase == 'i' ? ",\"s\":\"t\"" : ""
+            );
+            first = false;
+            total++;
+        }
+    }
+    SDL_UnlockSpinlock(&trace_lock_);
+    SDL_IOprintf(io, "\n]}\n");
+
+    const bool ok = SDL_CloseIO(io);
+    SDL_Log("trace: wrote %d events to %s", total, path);
+    return ok;
+}
+
+#define TRACE_BEGIN(name)   (trace_record_((name), 'B'), TRACE_WATCHDOG_ENTER_(name))
+#define TRACE_END(name)     (trace_record_((name), 'E'), TRACE_WATCHDOG_LEAVE_(name))
+#define TRACE_INSTANT(name) trace_record_((name), 'i')
+
+#else
+
+#define TRACE_BEGIN(name)   TRACE_WATCHDOG_ENTER_(name)
+#define TRACE_END(name)     TRACE_WATCHDOG_LEAVE_(name)
+#define TRACE_INSTANT(name) ((void) 0)
+
+static inline bool trace_dump(char const *path) {
+    (void) path;
+    return false;
+}
+
+#endif
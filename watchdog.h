@@ -0,0 +1,239 @@
+//
+// Frame-budget watchdog.
+//
+// The UI loop brackets every frame with watchdog_frame_begin()/watchdog_frame_end(). A background thread checks a
+// few times per budget whether the current frame is overdue; if so it notes which instrumented section (TRACE_BEGIN
+// / TRACE_END on the UI thread, see trace.h) is active and for how long. When the frame finally completes the stall
+// goes into a bounded list of the worst ones, which can be read back (watchdog_worst_stall) or written to storage
+// (watchdog_dump).
+//
+// Build with ENABLE_WATCHDOG (cmake -DENABLE_WATCHDOG=ON); otherwise every call is a no-op.
+//
+
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#ifndef WATCHDOG_BUDGET_MS
+#define WATCHDOG_BUDGET_MS 100
+#endif
+
+#ifndef WATCHDOG_OUTPUT_PATH
+#ifdef WHY_BADGE
+#define WATCHDOG_OUTPUT_PATH "SD0:stalls.txt"
+#else
+#define WATCHDOG_OUTPUT_PATH "stalls.txt"
+#endif
+#endif
+
+typedef struct {
+    SDL_Time wall;        // when the stalled frame started
+    Uint32 frame_ms;      // how long the frame took in total
+    Uint32 section_ms;    // how long `section` had been running when last seen
+    char const *section;  // innermost instrumented section seen during the stall
+} watchdog_stall_t;
+
+#ifdef ENABLE_WATCHDOG
+
+#define WATCHDOG_MAX_DEPTH  8
+#define WATCHDOG_MAX_STALLS 16
+
+static struct {
+    SDL_Thread *thread;
+    SDL_Semaphore *stop;
+    SDL_Mutex *lock; // guards pending and worst
+    SDL_ThreadID ui_thread;
+    Uint32 budget_ms;
+
+    SDL_AtomicInt in_frame;
+    SDL_AtomicU32 frame_start_ms;
+    SDL_AtomicInt depth;
+    void *section_name[WATCHDOG_MAX_DEPTH];
+    SDL_AtomicU32 section_since_ms[WATCHDOG_MAX_DEPTH];
+
+    bool pending_active;
+    watchdog_stall_t pending;
+    watchdog_stall_t worst[WATCHDOG_MAX_STALLS]; // sorted, longest first
+    int num_worst;
+} watchdog_;
+
+static inline void watchdog_enter_(char const *name) {
+    if (!watchdog_.thread || SDL_GetCurrentThreadID() != watchdog_.ui_thread) {
+        return;
+    }
+    const int depth = SDL_GetAtomicInt(&watchdog_.depth);
+    if (depth < WATCHDOG_MAX_DEPTH) {
+        SDL_SetAtomicPointer(&watchdog_.section_name[depth], (void *) name);
+        SDL_SetAtomicU32(&watchdog_.section_since_ms[depth], (Uint32) SDL_GetTicks());
+    }
+    SDL_SetAtomicInt(&watchdog_.depth, depth + 1);
+}
+
+static inline void watchdog_leave_(char const *name) {
+    (void) name;
+    if (!watchdog_.thread || SDL_GetCurrentThreadID() != watchdog_.ui_thread) {
+        return;
+    }
+    const int depth = SDL_GetAtomicInt(&watchdog_.depth);
+    if (depth > 0) {
+        SDL_SetAtomicInt(&watchdog_.depth, depth - 1);
+    }
+}
+
+static int SDLCALL watchdog_thread_(void *data) {
+    (void) data;
+    const Sint32 interval = (Sint32) SDL_max(watchdog_.budget_ms / 4, 1);
+    while (!SDL_WaitSemaphoreTimeout(watchdog_.stop, interval)) {
+        if (!SDL_GetAtomicInt(&watchdog_.in_frame)) {
+            continue;
+        }
+        const Uint32 now = (Uint32) SDL_GetTicks();
+        const Uint32 frame_ms = now - SDL_GetAtomicU32(&watchdog_.frame_start_ms);
+        if (frame_ms <= watchdog_.budget_ms) {
+            continue;
+        }
+
+        const int depth = SDL_min(SDL_GetAtomicInt(&watchdog_.depth), WATCHDOG_MAX_DEPTH);
+        char const *section = "(no section)";
+        Uint32 section_ms = frame_ms;
+        if (depth > 0) {
+            section = (char const *) SDL_GetAtomicPointer(&watchdog_.section_name[depth - 1]);
+            section_ms = now - SDL_GetAtomicU32(&watchdog_.section_since_ms[depth - 1]);
+        }
+
+        SDL_LockMutex(watchdog_.lock);
+        const bool first = !watchdog_.pending_active;
+        if (first) {
+            watchdog_.pending_active = true;
+            SDL_GetCurrentTime(&watchdog_.pending.wall);
+            watchdog_.pending.wall -= (SDL_Time) frame_ms * SDL_NS_PER_MS;
+            watchdog_.pending.section = section;
+            watchdog_.pending.section_ms = section_ms;
+        } else if (section == watchdog_.pending.section || section_ms > watchdog_.pending.section_ms) {
+            // Blame whichever section has been holding the frame the longest
+            watchdog_.pending.section = section;
+            watchdog_.pending.section_ms = section_ms;
+        }
+        watchdog_.pending.frame_ms = frame_ms;
+        SDL_UnlockMutex(watchdog_.lock);
+
+        if (first) {
+            SDL_Log("watchdog: frame over budget (%u ms > %u ms) in %s", frame_ms, watchdog_.budget_ms, section);
+        }
+    }
+    return 0;
+}
+
+static inline bool watchdog_start(Uint32 budget_ms) {
+    watchdog_.budget_ms = budget_ms;
+    watchdog_.ui_thread = SDL_GetCurrentThreadID();
+    watchdog_.lock = SDL_CreateMutex();
+    watchdog_.stop = SDL_CreateSemaphore(0);
+    if (!watchdog_.lock || !watchdog_.stop) {
+        return false;
+    }
+    watchdog_.thread = SDL_CreateThread(watchdog_thread_, "watchdog", NULL);
+    if (!watchdog_.thread) {
+        SDL_Log("watchdog: could not start: %s", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+static inline void watchdog_stop(void) {
+    if (!watchdog_.thread) {
+        return;
+    }
+    SDL_SignalSemaphore(watchdog_.stop);
+    SDL_WaitThread(watchdog_.thread, NULL);
+    watchdog_.thread = NULL;
+    SDL_DestroySemaphore(watchdog_.stop);
+    SDL_DestroyMutex(watchdog_.lock);
+}
+
+static inline void watchdog_frame_begin(void) {
+    SDL_SetAtomicU32(&watchdog_.frame_start_ms, (Uint32) SDL_GetTicks());
+    SDL_SetAtomicInt(&watchdog_.in_frame, 1);
+}
+
+static inline void watchdog_frame_end(void) {
+    if (!watchdog_.thread) {
+        return;
+    }
+    SDL_SetAtomicInt(&watchdog_.in_frame, 0);
+    const Uint32 frame_ms = (Uint32) SDL_GetTicks() - SDL_GetAtomicU32(&watchdog_.frame_start_ms);
+
+    SDL_LockMutex(watchdog_.lock);
+    if (!watchdog_.pending_active && frame_ms <= watchdog_.budget_ms) {
+        SDL_UnlockMutex(watchdog_.lock);
+        return;
+    }
+    watchdog_stall_t stall = watchdog_.pending;
+    if (!watchdog_.pending_active) {
+        // Finished between two checks: over budget, but nobody saw what it was doing
+        SDL_GetCurrentTime(&stall.wall);
+        stall.wall -= (SDL_Time) frame_ms * SDL_NS_PER_MS;
+        stall.section = "(unobserved)";
+        stall.section_ms = frame_ms;
+    }
+    stall.frame_ms = frame_ms;
+    watchdog_.pending_active = false;
+
+    int at = watchdog_.num_worst;
+    while (at > 0 && watchdog_.worst[at - 1].frame_ms < stall.frame_ms) {
+        at--;
+    }
+    if (at < WATCHDOG_MAX_STALLS) {
+        const int last = SDL_min(watchdog_.num_worst, WATCHDOG_MAX_STALLS - 1);
+        SDL_memmove(&watchdog_.worst[at + 1], &watchdog_.worst[at], (last - at) * sizeof(watchdog_stall_t));
+        watchdog_.worst[at] = stall;
+        if (watchdog_.num_worst < WATCHDOG_MAX_STALLS) {
+            watchdog_.num_worst++;
+        }
+    }
+    SDL_UnlockMutex(watchdog_.lock);
+}
+
+// Copy out the n-th worst stall so far (0 = worst). Returns false when there are fewer.
+static inline bool watchdog_worst_stall(int n, watchdog_stall_t *out) {
+    if (!watchdog_.thread) {
+        return false;
+    }
+    SDL_LockMutex(watchdog_.lock);
+    const bool found = n < watchdog_.num_worst;
+    if (found) {
+        *out = watchdog_.worst[n];
+    }
+    SDL_UnlockMutex(watchdog_.lock);
+    return found;
+}
+
+static inline bool watchdog_dump(char const *path) {
+    SDL_IOStream *io = SDL_IOFromFile(path, "w");
+    if (!io) {
+        SDL_Log("watchdog: could not open %s: %s", path, SDL_GetError());
+        return false;
+    }
+    SDL_IOprintf(io, "# worst frames over the %u ms budget\n# start(local)        frame_ms  section_ms  section\n",
+                 watchdog_.budget_ms);
+    watchdog_stall_t stall;
+    for (int i = 0; watchdog_worst_stall(i, &stall); i++) {
+        SDL_DateTime dt;
+        SDL_TimeToDateTime(stall.wall, &dt, true);
+        SDL_IOprintf(io, "%04d-%02d-%02d %02d:%02d:%02d.%03d %8u %11u  %s\n",
+                     dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second, dt.nanosecond / 1000000,
+                     stall.frame_ms, stall.section_ms, stall.section);
+    }
+    return SDL_CloseIO(io);
+}
+
+#else
+
+static inline bool watchdog_start(Uint32 budget_ms) { (void) budget_ms; return false; }
+static inline void watchdog_stop(void) {}
+static inline void watchdog_frame_begin(void) {}
+static inline void watchdog_frame_end(void) {}
+static inline bool watchdog_worst_stall(int n, watchdog_stall_t *out) { (void) n; (void) out; return false; }
+static inline bool watchdog_dump(char const *path) { (void) path; return false; }
+
+#endif